@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Profiler
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+#include <xmr/utility/profiler/profiler.hpp>
+
+#include <sandbox/thread.hpp>
+#include <sandbox/timer.hpp>
+#include <sandbox/topology.hpp>
+
+/* Measure Contended Atomic Read-Modify-Write
+
+A single `lock cmpxchg` handoff between two cores is cheap compared to K cores
+hammering the same line, which is what shared counters and reference counts see.
+
+For every operation, core selection policy and K:
+- Spin up K threads, pinned to the first K cores of the policy order.
+- All threads wait for the start signal.
+- Every thread repeats the operation on one shared line until the stop signal,
+  timing each operation on its own.
+- Report aggregate operations per second, how evenly the operations were split
+  between the threads and the latency distribution of a single operation.
+
+The per-operation timing adds two rdtsc to every operation, so the absolute
+throughput is a little lower than without it. It affects all K equally though.
+The cost of one rdtsc is calibrated at startup and removed from the latencies.
+*/
+
+#define DURATION_MS 250
+#define SAMPLES 1048576
+#define CACHE_LINE_SIZE 64
+
+enum class rmw_op {
+	fetch_add,
+	cas,
+	xchg,
+};
+
+static const char* rmw_op_name(rmw_op op)
+{
+	switch (op) {
+	case rmw_op::fetch_add:
+		return "fetch_add";
+	case rmw_op::cas:
+		return "cas";
+	case rmw_op::xchg:
+		return "xchg";
+	}
+	return "unknown";
+}
+
+struct shared_data {
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> value;
+	alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> arrived;
+	alignas(CACHE_LINE_SIZE) std::atomic<bool> start;
+	std::atomic<bool> stop;
+};
+
+struct alignas(CACHE_LINE_SIZE) thread_data {
+	uint32_t     processor;
+	shared_data* shared;
+
+	uint64_t              operations;
+	std::vector<uint32_t> samples;
+};
+
+template<rmw_op Op>
+void rmw_main(thread_data* td)
+{
+	sandbox::thread_affinity(0, td->processor);
+	sandbox::thread_priority_rt();
+
+	shared_data* sd = td->shared;
+
+	// Wait for everyone else.
+	sd->arrived.fetch_add(1);
+	while (!sd->start.load(std::memory_order_acquire)) { // no-op
+	}
+
+	uint64_t operations = 0;
+	while (!sd->stop.load(std::memory_order_relaxed)) {
+		uint64_t t0 = xmr::utility::profiler::clock::tsc::now();
+		if constexpr (Op == rmw_op::fetch_add) {
+			sd->value.fetch_add(1);
+		} else if constexpr (Op == rmw_op::cas) {
+			uint64_t expected = sd->value.load(std::memory_order_relaxed);
+			while (!sd->value.compare_exchange_weak(expected, expected + 1)) { // no-op
+			}
+		} else if constexpr (Op == rmw_op::xchg) {
+			sd->value.exchange(t0);
+		}
+		uint64_t t1 = xmr::utility::profiler::clock::tsc::now();
+
+		// Keep the most recent samples, older ones are overwritten.
+		td->samples[operations % SAMPLES] = uint32_t(std::min<uint64_t>(t1 - t0, UINT32_MAX));
+		operations++;
+	}
+	td->operations = operations;
+}
+
+struct rmw_result {
+	double ops_per_second;
+	double fairness; // Jain's fairness index, 1.0 is perfectly fair.
+	double min_max;  // Ratio of the slowest to the fastest thread.
+
+	std::shared_ptr<xmr::utility::profiler::profiler> profiler;
+};
+
+rmw_result rmw_run(rmw_op op, const std::vector<uint32_t>& processors, uint64_t floor)
+{
+	shared_data sd;
+	sd.value   = 0;
+	sd.arrived = 0;
+	sd.start   = false;
+	sd.stop    = false;
+
+	std::vector<thread_data> tds(processors.size());
+	std::vector<std::thread> threads;
+	for (size_t n = 0; n < processors.size(); n++) {
+		tds[n].processor  = processors[n];
+		tds[n].shared     = &sd;
+		tds[n].operations = 0;
+		tds[n].samples.resize(SAMPLES);
+
+		switch (op) {
+		case rmw_op::fetch_add:
+			threads.emplace_back(rmw_main<rmw_op::fetch_add>, &tds[n]);
+			break;
+		case rmw_op::cas:
+			threads.emplace_back(rmw_main<rmw_op::cas>, &tds[n]);
+			break;
+		case rmw_op::xchg:
+			threads.emplace_back(rmw_main<rmw_op::xchg>, &tds[n]);
+			break;
+		}
+	}
+
+	// Start everyone at once, and stop them after the duration.
+	while (sd.arrived.load() != processors.size()) {
+		std::this_thread::yield();
+	}
+	auto t0 = std::chrono::high_resolution_clock::now();
+	sd.start.store(true, std::memory_order_release);
+	std::this_thread::sleep_for(std::chrono::milliseconds(DURATION_MS));
+	sd.stop.store(true, std::memory_order_relaxed);
+	auto t1 = std::chrono::high_resolution_clock::now();
+
+	// Block by joining back together with the threads.
+	for (auto& thread : threads) {
+		if (thread.joinable())
+			thread.join();
+	}
+
+	rmw_result result;
+	result.profiler = std::make_shared<xmr::utility::profiler::profiler>();
+
+	double sum = 0, sum_sq = 0, min = double(UINT64_MAX), max = 0;
+	for (auto& td : tds) {
+		double ops = double(td.operations);
+		sum += ops;
+		sum_sq += ops * ops;
+		min = std::min(min, ops);
+		max = std::max(max, ops);
+
+		for (size_t n = 0, end = size_t(std::min<uint64_t>(td.operations, SAMPLES)); n < end; n++) {
+			result.profiler->track(sandbox::timer_subtract(td.samples[n], floor), 0);
+		}
+	}
+	result.ops_per_second = sum / std::chrono::duration<double>(t1 - t0).count();
+	result.fairness       = (sum * sum) / (double(tds.size()) * sum_sq);
+	result.min_max        = min / max;
+
+	return result;
+}
+
+std::int32_t main(std::int32_t argc, const char* argv[])
+{
+	auto     topology    = sandbox::topology_detect();
+	uint32_t max_core_id = uint32_t(topology.size());
+
+	std::vector<sandbox::topology_policy> policies = {sandbox::topology_policy::local, sandbox::topology_policy::spread};
+	if (argc > 1) {
+		policies.resize(1);
+		if (!sandbox::topology_policy_parse(argv[1], policies[0])) {
+			printf("Usage: %s [local|remote|spread]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// Calibrate while nothing else is running yet, on a thread of its own. Pinning the main thread instead would leave
+	// it on core 0 with worker 0, where it has to wait for a spinning real-time thread to start and stop every run.
+	sandbox::timer_overhead floor;
+	std::thread([&floor]() {
+		sandbox::thread_affinity(0, 0);
+		floor = sandbox::timer_calibrate([]() { return xmr::utility::profiler::clock::tsc::now(); });
+	}).join();
+	double floor_ns = xmr::utility::profiler::clock::tsc::to_nanoseconds(double(floor.min));
+
+	std::ofstream file("atomics.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "op,policy,threads,ops/s,fairness,min/max,p50,p99,p99.9,floor" << std::endl;
+
+	printf("Testing for %" PRIu32 "ms per run, subtracting the tsc::now() floor of %.1fns...\n", uint32_t(DURATION_MS), floor_ns);
+	printf("Op        | Policy |   K |  Mops/s  | Jain  | Min/Max |   50.00%%  |   99.00%%  |   99.90%%  \n");
+	printf("----------+--------+-----+----------+-------+---------+-----------+-----------+-----------\n");
+	for (auto op : {rmw_op::fetch_add, rmw_op::cas, rmw_op::xchg}) {
+		for (auto policy : policies) {
+			auto order = sandbox::topology_order(topology, 0, policy, true);
+			for (size_t k = 1; k <= max_core_id; k++) {
+				auto r = rmw_run(op, std::vector<uint32_t>(order.begin(), order.begin() + k), floor.min);
+
+				double p50  = xmr::utility::profiler::clock::tsc::to_nanoseconds(r.profiler->percentile_events(0.50));
+				double p99  = xmr::utility::profiler::clock::tsc::to_nanoseconds(r.profiler->percentile_events(0.99));
+				double p999 = xmr::utility::profiler::clock::tsc::to_nanoseconds(r.profiler->percentile_events(0.999));
+				printf("%-10s|%-8s|%4zu |%9.2f |%6.3f |%8.3f |%8.1fns |%8.1fns |%8.1fns\n", rmw_op_name(op), sandbox::topology_policy_name(policy), k,
+					   r.ops_per_second / 1000000.0, r.fairness, r.min_max, p50, p99, p999);
+				file << rmw_op_name(op) << "," << sandbox::topology_policy_name(policy) << "," << k << "," << r.ops_per_second << "," << r.fairness << "," << r.min_max << "," << p50 << "," << p99 << "," << p999 << "," << floor_ns << std::endl;
+			}
+		}
+	}
+	file.close();
+
+	std::cin.get();
+	return 0;
+}
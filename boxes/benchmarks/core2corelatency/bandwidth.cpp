@@ -0,0 +1,219 @@
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+#include <xmr/utility/profiler/profiler.hpp>
+
+#include <sandbox/optimize.hpp>
+#include <sandbox/thread.hpp>
+
+#include "core2corelatency.hpp"
+
+/* Measure Core To Core Bandwidth
+
+The flag ping-pong only tells us how long a single line takes to move between
+two cores. Handing off a whole buffer (a frame, a packet, ...) instead moves
+many lines, and the cost per line drops as the transfers start to overlap.
+
+For every pair of cores and every transfer size:
+- The writer waits until the reader has consumed the previous transfer.
+- The writer records time, fills N lines and publishes the sequence number.
+- The reader waits for the sequence number, reads all N lines and records time.
+- The reader signals that it is done with the buffer.
+- Repeat for N iterations.
+
+The measured time covers filling, transferring and consuming the buffer, which
+is exactly what a cross-thread handoff costs.
+*/
+
+#define BANDWIDTH_ITERATIONS 10000
+#define BANDWIDTH_MAX_LINES 128
+#define CACHE_LINE_SIZE 64
+
+struct alignas(CACHE_LINE_SIZE) cache_line {
+	uint64_t data[CACHE_LINE_SIZE / sizeof(uint64_t)];
+};
+
+struct bandwidth_data {
+	// Each flag lives on its own line, so only the buffer itself is contended.
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> ready;
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> done;
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> time;
+
+	uint32_t reader;
+	uint32_t writer;
+	size_t   lines;
+
+	std::vector<cache_line> buffer;
+
+	// Profiler storage
+	std::shared_ptr<xmr::utility::profiler::profiler> profiler;
+};
+
+static void bandwidth_read_main(bandwidth_data* bd)
+{
+	sandbox::thread_affinity(0, bd->reader);
+	sandbox::thread_priority_rt();
+
+	for (uint64_t idx = 1; idx <= BANDWIDTH_ITERATIONS; idx++) {
+		// Wait for the writer to publish the buffer.
+		while (bd->ready.load(std::memory_order_acquire) != idx) { // no-op
+		}
+
+		// Consume every word of every line.
+		uint64_t sum = 0;
+		for (size_t n = 0; n < bd->lines; n++) {
+			for (size_t m = 0; m < (CACHE_LINE_SIZE / sizeof(uint64_t)); m++) {
+				sum += bd->buffer[n].data[m];
+			}
+		}
+		sandbox::do_not_optimize(sum);
+
+		// Record time and store.
+		uint64_t time = xmr::utility::profiler::clock::tsc::now();
+		bd->profiler->track(time, bd->time.load(std::memory_order_relaxed));
+
+		// Hand the buffer back to the writer.
+		bd->done.store(idx, std::memory_order_release);
+	}
+}
+
+static void bandwidth_write_main(bandwidth_data* bd)
+{
+	sandbox::thread_affinity(0, bd->writer);
+	sandbox::thread_priority_rt();
+
+	for (uint64_t idx = 1; idx <= BANDWIDTH_ITERATIONS; idx++) {
+		// Wait until the reader is done with the previous transfer.
+		while (bd->done.load(std::memory_order_acquire) != (idx - 1)) { // no-op
+		}
+
+		// Record time, fill the buffer and publish it.
+		uint64_t time = xmr::utility::profiler::clock::tsc::now();
+		for (size_t n = 0; n < bd->lines; n++) {
+			for (size_t m = 0; m < (CACHE_LINE_SIZE / sizeof(uint64_t)); m++) {
+				bd->buffer[n].data[m] = idx;
+			}
+		}
+		bd->time.store(time, std::memory_order_relaxed);
+		bd->ready.store(idx, std::memory_order_release);
+	}
+}
+
+std::int32_t main_bandwidth(std::int32_t argc, const char* argv[])
+{
+	// Transfer sizes are powers of two, from a single line up to the maximum.
+	size_t max_lines = BANDWIDTH_MAX_LINES;
+	if (argc > 1) {
+		max_lines = strtoull(argv[1], nullptr, 10);
+		if (max_lines == 0) {
+			printf("Usage: bandwidth [max lines=%d]\n", BANDWIDTH_MAX_LINES);
+			return 1;
+		}
+	}
+	std::vector<size_t> sizes;
+	for (size_t lines = 1; lines <= max_lines; lines *= 2) {
+		sizes.push_back(lines);
+	}
+
+	std::map<std::pair<uint32_t, uint32_t>, std::vector<std::shared_ptr<xmr::utility::profiler::profiler>>> profilers;
+
+	uint32_t max_core_id = std::thread::hardware_concurrency();
+	printf("Measuring %zu transfer sizes (%zu to %zu bytes) for %" PRIu32 " cores...\n", sizes.size(),
+		   size_t(CACHE_LINE_SIZE), sizes.back() * CACHE_LINE_SIZE, max_core_id);
+	for (uint32_t idx = 0; idx < max_core_id; idx++) {
+		for (uint32_t jdx = 0; jdx < max_core_id; jdx++) {
+			// Skip identical cores, there is no transfer to self.
+			if (idx == jdx) {
+				continue;
+			}
+
+			std::vector<std::shared_ptr<xmr::utility::profiler::profiler>> results;
+			for (size_t lines : sizes) {
+				// Create and initialize structures.
+				auto bd    = std::make_shared<bandwidth_data>();
+				bd->ready  = 0;
+				bd->done   = 0;
+				bd->time   = 0;
+				bd->reader = idx;
+				bd->writer = jdx;
+				bd->lines  = lines;
+				bd->buffer.resize(lines);
+				bd->profiler = std::make_shared<xmr::utility::profiler::profiler>();
+
+				// Spawn both threads.
+				std::thread a(bandwidth_read_main, bd.get());
+				std::thread b(bandwidth_write_main, bd.get());
+
+				// Block by joining back together with the threads.
+				if (a.joinable())
+					a.join();
+				if (b.joinable())
+					b.join();
+
+				results.push_back(bd->profiler);
+			}
+			profilers.emplace(std::pair<uint32_t, uint32_t>{idx, jdx}, results);
+		}
+		printf("%3" PRIu32 " done\n", idx);
+	}
+
+	// Print one matrix per transfer size.
+	for (size_t sdx = 0; sdx < sizes.size(); sdx++) {
+		size_t bytes = sizes[sdx] * CACHE_LINE_SIZE;
+		printf("\n%zu lines (%zu bytes): GB/s | ns/line\n", sizes[sdx], bytes);
+		for (uint32_t idx = 0; idx < max_core_id; idx++) {
+			printf("%3" PRIu32 " |", idx);
+			for (uint32_t jdx = 0; jdx < max_core_id; jdx++) {
+				auto value = profilers.find({idx, jdx});
+				if (value == profilers.end()) {
+					printf("                 |");
+					continue;
+				}
+
+				double ns = xmr::utility::profiler::clock::tsc::to_nanoseconds(value->second[sdx]->average_time());
+				printf("%6.2f | %6.2f |", double(bytes) / ns, ns / double(sizes[sdx]));
+			}
+			printf("\n");
+		}
+	}
+
+	// Write results to file.
+	std::ofstream file("bandwidth.csv", std::ios_base::out | std::ios_base::trunc);
+	for (size_t sdx = 0; sdx < sizes.size(); sdx++) {
+		size_t bytes = sizes[sdx] * CACHE_LINE_SIZE;
+		for (size_t table = 0; table < 2; table++) {
+			file << (table == 0 ? "GB/s @ " : "ns/line @ ") << bytes << ",";
+			for (size_t n = 0; n < max_core_id; n++) {
+				file << n << ",";
+			}
+			file << std::endl;
+			for (uint32_t n = 0; n < max_core_id; n++) {
+				file << n << ",";
+				for (uint32_t m = 0; m < max_core_id; m++) {
+					auto value = profilers.find({n, m});
+					if (value == profilers.end()) {
+						file << "x"
+							 << ",";
+						continue;
+					}
+
+					double ns = xmr::utility::profiler::clock::tsc::to_nanoseconds(value->second[sdx]->average_time());
+					file << (table == 0 ? (double(bytes) / ns) : (ns / double(sizes[sdx]))) << ",";
+				}
+				file << std::endl;
+			}
+			file << std::endl;
+		}
+	}
+	file.close();
+
+	return 0;
+}
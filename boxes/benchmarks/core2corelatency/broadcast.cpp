@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+#include <xmr/utility/profiler/profiler.hpp>
+
+#include <sandbox/thread.hpp>
+#include <sandbox/topology.hpp>
+
+#include "core2corelatency.hpp"
+
+/* Measure One To Many Latency
+
+A single write that wakes several spinning readers does not cost the same as
+waking one, since the line has to be shared out to every reader. This mode uses
+one writer core and K reader cores, all spinning on the same line:
+- All readers spin on the shared line.
+- The writer records time and stores the iteration number.
+- Each reader records time once it observes the store, and checks in.
+- The writer waits for all readers to check in, then tracks the earliest and
+  latest reader time.
+- Repeat for N iterations, and for K = 1 up to every other core.
+
+Readers are picked by topology domain relative to the writer:
+- local: readers sharing the writer's L3 first, then the rest.
+- remote: readers outside the writer's L3 first, then the rest.
+- spread: round-robin across all L3 domains, starting with the writer's.
+*/
+
+#define BROADCAST_ITERATIONS 100000
+#define CACHE_LINE_SIZE 64
+
+struct alignas(CACHE_LINE_SIZE) broadcast_slot {
+	std::atomic<uint64_t> time;
+};
+
+struct broadcast_data {
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> flag;
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> arrived;
+
+	uint32_t              writer;
+	std::vector<uint32_t> readers;
+
+	std::unique_ptr<broadcast_slot[]> slots;
+
+	// Profiler storage
+	std::shared_ptr<xmr::utility::profiler::profiler> first;
+	std::shared_ptr<xmr::utility::profiler::profiler> last;
+};
+
+static void broadcast_read_main(broadcast_data* bd, size_t index)
+{
+	sandbox::thread_affinity(0, bd->readers[index]);
+	sandbox::thread_priority_rt();
+
+	for (uint64_t idx = 1; idx <= BROADCAST_ITERATIONS; idx++) {
+		// Wait until we are signalled.
+		while (bd->flag.load(std::memory_order_acquire) != idx) { // no-op
+		}
+
+		// Record time and check in.
+		bd->slots[index].time.store(xmr::utility::profiler::clock::tsc::now(), std::memory_order_relaxed);
+		bd->arrived.fetch_add(1, std::memory_order_release);
+	}
+}
+
+static void broadcast_write_main(broadcast_data* bd)
+{
+	sandbox::thread_affinity(0, bd->writer);
+	sandbox::thread_priority_rt();
+
+	const uint64_t count = bd->readers.size();
+	for (uint64_t idx = 1; idx <= BROADCAST_ITERATIONS; idx++) {
+		// Record time and signal all readers.
+		uint64_t time = xmr::utility::profiler::clock::tsc::now();
+		bd->flag.store(idx, std::memory_order_release);
+
+		// Wait until every reader has checked in.
+		while (bd->arrived.load(std::memory_order_acquire) != (idx * count)) { // no-op
+		}
+
+		// Track the first and last observer.
+		uint64_t first = UINT64_MAX, last = 0;
+		for (size_t n = 0; n < count; n++) {
+			uint64_t value = bd->slots[n].time.load(std::memory_order_relaxed);
+			first          = std::min(first, value);
+			last           = std::max(last, value);
+		}
+		bd->first->track(first, time);
+		bd->last->track(last, time);
+	}
+}
+
+std::int32_t main_broadcast(std::int32_t argc, const char* argv[])
+{
+	auto     topology    = sandbox::topology_detect();
+	uint32_t max_core_id = uint32_t(topology.size());
+
+	uint32_t writer = 0;
+	if (argc > 1) {
+		writer = uint32_t(strtoul(argv[1], nullptr, 10));
+	}
+	std::vector<sandbox::topology_policy> policies = {sandbox::topology_policy::local, sandbox::topology_policy::remote, sandbox::topology_policy::spread};
+	if (argc > 2) {
+		policies.resize(1);
+		if (!sandbox::topology_policy_parse(argv[2], policies[0])) {
+			policies.clear();
+		}
+	}
+	if ((writer >= max_core_id) || (max_core_id < 2) || policies.empty()) {
+		printf("Usage: broadcast [writer=0] [local|remote|spread]\n");
+		return 1;
+	}
+
+	std::ofstream file("broadcast.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "policy,readers,first avg,first p99,last avg,last p99" << std::endl;
+
+	printf("Broadcasting from core %" PRIu32 " (L3 domain %" PRIu32 ")...\n", writer, topology[writer].l3);
+	printf("Policy |   K | First (avg) | First (99%%) | Last (avg)  | Last (99%%)\n");
+	printf("-------+-----+-------------+-------------+-------------+------------\n");
+	for (auto policy : policies) {
+		auto order = sandbox::topology_order(topology, writer, policy, false);
+		for (size_t k = 1; k <= order.size(); k++) {
+			// Create and initialize structures.
+			broadcast_data bd;
+			bd.flag    = 0;
+			bd.arrived = 0;
+			bd.writer  = writer;
+			bd.readers.assign(order.begin(), order.begin() + k);
+			bd.slots = std::make_unique<broadcast_slot[]>(k);
+			bd.first = std::make_shared<xmr::utility::profiler::profiler>();
+			bd.last  = std::make_shared<xmr::utility::profiler::profiler>();
+
+			// Spawn all threads.
+			std::vector<std::thread> threads;
+			for (size_t n = 0; n < k; n++) {
+				threads.emplace_back(broadcast_read_main, &bd, n);
+			}
+			threads.emplace_back(broadcast_write_main, &bd);
+
+			// Block by joining back together with the threads.
+			for (auto& thread : threads) {
+				if (thread.joinable())
+					thread.join();
+			}
+
+			double first_avg = xmr::utility::profiler::clock::tsc::to_nanoseconds(bd.first->average_time());
+			double first_99  = xmr::utility::profiler::clock::tsc::to_nanoseconds(bd.first->percentile_events(0.99));
+			double last_avg  = xmr::utility::profiler::clock::tsc::to_nanoseconds(bd.last->average_time());
+			double last_99   = xmr::utility::profiler::clock::tsc::to_nanoseconds(bd.last->percentile_events(0.99));
+			printf("%-6s | %3zu | %8.1f ns | %8.1f ns | %8.1f ns | %8.1f ns\n", sandbox::topology_policy_name(policy), k, first_avg, first_99, last_avg, last_99);
+			file << sandbox::topology_policy_name(policy) << "," << k << "," << first_avg << "," << first_99 << "," << last_avg << "," << last_99 << std::endl;
+		}
+	}
+	file.close();
+
+	return 0;
+}
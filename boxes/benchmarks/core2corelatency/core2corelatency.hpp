@@ -0,0 +1,26 @@
+#pragma once
+#include <cinttypes>
+
+/* Modes
+
+Every mode is a standalone entry point which receives the remaining arguments,
+with argv[0] being the name of the mode itself.
+*/
+
+// Stream N cache lines from a writer core to a reader core.
+std::int32_t main_bandwidth(std::int32_t argc, const char* argv[]);
+
+// Wake K reader cores with a single write and measure the first and last observer.
+std::int32_t main_broadcast(std::int32_t argc, const char* argv[]);
+
+// Run the flag handshake with the shared fields at different strides to expose false sharing.
+std::int32_t main_layout(std::int32_t argc, const char* argv[]);
+
+// Send batched messages through an SPSC ring and measure throughput and end-to-end latency.
+std::int32_t main_spsc(std::int32_t argc, const char* argv[]);
+
+// Wake a blocked reader core through the kernel and measure how long until it runs again.
+std::int32_t main_wakeup(std::int32_t argc, const char* argv[]);
+
+// Estimate the TSC offset of every core relative to one origin core.
+std::int32_t main_skew(std::int32_t argc, const char* argv[]);
@@ -0,0 +1,153 @@
+#pragma once
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Just enough JSON to read our own files back.
+struct json_value {
+	enum class type {
+		null,
+		boolean,
+		number,
+		string,
+		array,
+		object,
+	};
+
+	type                              kind    = type::null;
+	bool                              boolean = false;
+	double                            number  = 0;
+	std::string                       string;
+	std::vector<json_value>           array;
+	std::map<std::string, json_value> object;
+
+	const json_value& operator[](const char* key) const
+	{
+		static const json_value null;
+		auto                    itr = object.find(key);
+		return (itr != object.end()) ? itr->second : null;
+	}
+};
+
+class json_parser {
+	const char* _cur;
+	const char* _end;
+
+	void skip()
+	{
+		while ((_cur < _end) && isspace(static_cast<unsigned char>(*_cur))) {
+			_cur++;
+		}
+	}
+
+	void expect(char c)
+	{
+		skip();
+		if ((_cur >= _end) || (*_cur != c)) {
+			throw std::runtime_error(std::string("Expected '") + c + "'");
+		}
+		_cur++;
+	}
+
+	bool match(const char* word)
+	{
+		size_t length = strlen(word);
+		if ((size_t(_end - _cur) >= length) && (strncmp(_cur, word, length) == 0)) {
+			_cur += length;
+			return true;
+		}
+		return false;
+	}
+
+	std::string parse_string()
+	{
+		expect('"');
+		std::string value;
+		while ((_cur < _end) && (*_cur != '"')) {
+			if ((*_cur == '\\') && ((_cur + 1) < _end)) {
+				_cur++;
+				switch (*_cur) {
+				case 'n':
+					value.push_back('\n');
+					break;
+				case 't':
+					value.push_back('\t');
+					break;
+				default:
+					value.push_back(*_cur);
+					break;
+				}
+			} else {
+				value.push_back(*_cur);
+			}
+			_cur++;
+		}
+		expect('"');
+		return value;
+	}
+
+	public:
+	json_parser(const std::string& text) : _cur(text.data()), _end(text.data() + text.size()) {}
+
+	json_value parse()
+	{
+		json_value value;
+		skip();
+		if (_cur >= _end) {
+			throw std::runtime_error("Unexpected end of input");
+		}
+
+		if (*_cur == '{') {
+			value.kind = json_value::type::object;
+			_cur++;
+			skip();
+			if ((_cur < _end) && (*_cur == '}')) {
+				_cur++;
+				return value;
+			}
+			do {
+				std::string key = parse_string();
+				expect(':');
+				value.object.emplace(key, parse());
+				skip();
+			} while ((_cur < _end) && (*_cur == ',') && (++_cur));
+			expect('}');
+		} else if (*_cur == '[') {
+			value.kind = json_value::type::array;
+			_cur++;
+			skip();
+			if ((_cur < _end) && (*_cur == ']')) {
+				_cur++;
+				return value;
+			}
+			do {
+				value.array.push_back(parse());
+				skip();
+			} while ((_cur < _end) && (*_cur == ',') && (++_cur));
+			expect(']');
+		} else if (*_cur == '"') {
+			value.kind   = json_value::type::string;
+			value.string = parse_string();
+		} else if (match("true")) {
+			value.kind    = json_value::type::boolean;
+			value.boolean = true;
+		} else if (match("false")) {
+			value.kind = json_value::type::boolean;
+		} else if (match("null")) {
+			// Already null.
+		} else {
+			char* end    = nullptr;
+			value.kind   = json_value::type::number;
+			value.number = strtod(_cur, &end);
+			if (end == _cur) {
+				throw std::runtime_error("Unexpected character");
+			}
+			_cur = end;
+		}
+		return value;
+	}
+};
@@ -0,0 +1,208 @@
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+#include <xmr/utility/profiler/profiler.hpp>
+
+#include <sandbox/thread.hpp>
+
+#include "core2corelatency.hpp"
+
+/* Measure False Sharing
+
+The default mode keeps `ready`, `data` and the profiler next to each other, so
+every flag the reader spins on shares a line with something the writer stores
+to. This mode runs the same handshake, but places each of the shared fields at
+a fixed stride from each other:
+- unpadded: 8 bytes, every field on the same line.
+- padded64: 64 bytes, one line per field.
+- padded128: 128 bytes, one line pair per field, which keeps the adjacent line
+  prefetcher from pulling in a neighbouring field.
+- paged: 4096 bytes, one page per field.
+
+The difference between the layouts is the cost of false sharing.
+*/
+
+#define LAYOUT_ITERATIONS 100000
+#define LAYOUT_PAGE_SIZE 4096
+
+enum layout_field : size_t {
+	FIELD_READ_READY,
+	FIELD_WRITE_READY,
+	FIELD_DATA,
+	FIELD_TIME,
+	FIELD_COUNT,
+};
+
+struct layout_type {
+	const char* name;
+	size_t      stride;
+};
+
+static const layout_type layouts[] = {
+	{"unpadded", sizeof(uint64_t)},
+	{"padded64", 64},
+	{"padded128", 128},
+	{"paged", LAYOUT_PAGE_SIZE},
+};
+
+struct layout_data {
+	uint32_t reader;
+	uint32_t writer;
+
+	std::atomic<uint64_t>* fields[FIELD_COUNT];
+
+	// Profiler storage
+	std::shared_ptr<xmr::utility::profiler::profiler> profiler;
+};
+
+static void layout_read_main(layout_data* ld)
+{
+	sandbox::thread_affinity(0, ld->reader);
+	sandbox::thread_priority_rt();
+
+	// Keep everything the writer does not touch off the shared lines.
+	auto                   profiler    = ld->profiler;
+	std::atomic<uint64_t>& read_ready  = *ld->fields[FIELD_READ_READY];
+	std::atomic<uint64_t>& write_ready = *ld->fields[FIELD_WRITE_READY];
+	std::atomic<uint64_t>& data        = *ld->fields[FIELD_DATA];
+	std::atomic<uint64_t>& time        = *ld->fields[FIELD_TIME];
+
+	for (uint64_t idx = 1; idx <= LAYOUT_ITERATIONS; idx++) {
+		// Wait for write thread to be ready.
+		while (write_ready.load() != idx) { // no-op
+		}
+		// Signal write thread that read thread is ready.
+		read_ready.store(idx);
+		// Wait until we are signalled
+		while (!data.load()) { // no-op
+		}
+		// Record time and store.
+		uint64_t now = xmr::utility::profiler::clock::tsc::now();
+		profiler->track(now, time.load());
+		// Reset data
+		data.store(0);
+	}
+}
+
+static void layout_write_main(layout_data* ld)
+{
+	sandbox::thread_affinity(0, ld->writer);
+	sandbox::thread_priority_rt();
+
+	std::atomic<uint64_t>& read_ready  = *ld->fields[FIELD_READ_READY];
+	std::atomic<uint64_t>& write_ready = *ld->fields[FIELD_WRITE_READY];
+	std::atomic<uint64_t>& data        = *ld->fields[FIELD_DATA];
+	std::atomic<uint64_t>& time        = *ld->fields[FIELD_TIME];
+
+	for (uint64_t idx = 1; idx <= LAYOUT_ITERATIONS; idx++) {
+		// Signal read thread to be ready.
+		write_ready.store(idx);
+		// Wait for read thread to be ready.
+		while (read_ready.load() != idx) { // no-op
+		}
+		// Record time and signal read thread.
+		time.store(xmr::utility::profiler::clock::tsc::now());
+		data.store(1);
+		// Wait until read thread resets data.
+		while (data.load()) { // no-op
+		}
+	}
+}
+
+static std::shared_ptr<xmr::utility::profiler::profiler> layout_run(const layout_type& layout, uint32_t reader, uint32_t writer)
+{
+	// Page aligned storage, large enough for the widest stride.
+	size_t                  size = LAYOUT_PAGE_SIZE * FIELD_COUNT;
+	std::unique_ptr<char[]> storage(new char[size + LAYOUT_PAGE_SIZE]);
+	char* base = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(storage.get()) + LAYOUT_PAGE_SIZE - 1) & ~uintptr_t(LAYOUT_PAGE_SIZE - 1));
+
+	layout_data ld;
+	ld.reader   = reader;
+	ld.writer   = writer;
+	ld.profiler = std::make_shared<xmr::utility::profiler::profiler>();
+	for (size_t n = 0; n < FIELD_COUNT; n++) {
+		ld.fields[n] = new (base + n * layout.stride) std::atomic<uint64_t>(0);
+	}
+
+	// Spawn both threads.
+	std::thread a(layout_read_main, &ld);
+	std::thread b(layout_write_main, &ld);
+
+	// Block by joining back together with the threads.
+	if (a.joinable())
+		a.join();
+	if (b.joinable())
+		b.join();
+
+	return ld.profiler;
+}
+
+std::int32_t main_layout(std::int32_t argc, const char* argv[])
+{
+	uint32_t max_core_id = std::thread::hardware_concurrency();
+
+	// Either a single pair, or every pair.
+	std::vector<std::pair<uint32_t, uint32_t>> pairs;
+	if (argc > 2) {
+		pairs.push_back({uint32_t(strtoul(argv[1], nullptr, 10)), uint32_t(strtoul(argv[2], nullptr, 10))});
+		if ((pairs[0].first >= max_core_id) || (pairs[0].second >= max_core_id) || (pairs[0].first == pairs[0].second)) {
+			printf("Usage: layout [reader writer]\n");
+			return 1;
+		}
+	} else {
+		for (uint32_t idx = 0; idx < max_core_id; idx++) {
+			for (uint32_t jdx = 0; jdx < max_core_id; jdx++) {
+				if (idx != jdx) {
+					pairs.push_back({idx, jdx});
+				}
+			}
+		}
+	}
+
+	std::ofstream file("layout.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "layout,reader,writer,average,p99.9,p99" << std::endl;
+
+	printf("Testing %zu pairs with %" PRIu64 " iterations each...\n", pairs.size(), uint64_t(LAYOUT_ITERATIONS));
+	printf("Layout    | Stride | Average    | 99.90%%     | 99.00%%     | vs. paged\n");
+	printf("----------+--------+------------+------------+------------+----------\n");
+
+	// Average, 99.90ile and 99.00ile, averaged over all pairs.
+	std::map<const layout_type*, std::array<double, 3>> results;
+	for (const auto& layout : layouts) {
+		auto& sums = results[&layout];
+		sums.fill(0);
+		for (auto pair : pairs) {
+			auto   p    = layout_run(layout, pair.first, pair.second);
+			double avg  = xmr::utility::profiler::clock::tsc::to_nanoseconds(p->average_time());
+			double p999 = xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.999));
+			double p99  = xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.99));
+			sums[0] += avg;
+			sums[1] += p999;
+			sums[2] += p99;
+			file << layout.name << "," << pair.first << "," << pair.second << "," << avg << "," << p999 << "," << p99 << std::endl;
+		}
+		for (auto& sum : sums) {
+			sum /= double(pairs.size());
+		}
+	}
+	file.close();
+
+	// The paged layout can not share anything, so it is the baseline.
+	double baseline = results[&layouts[std::size(layouts) - 1]][0];
+	for (const auto& layout : layouts) {
+		auto& sums = results[&layout];
+		printf("%-10s|%7zu |%8.1f ns |%8.1f ns |%8.1f ns |%+7.1f ns\n", layout.name, layout.stride, sums[0], sums[1], sums[2], sums[0] - baseline);
+	}
+
+	return 0;
+}
@@ -1,10 +1,14 @@
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cinttypes>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -18,6 +22,15 @@
 #include <xmr/utility/profiler/clock/tsc.hpp>
 #include <xmr/utility/profiler/profiler.hpp>
 
+#include <sandbox/histogram.hpp>
+#include <sandbox/sampling.hpp>
+#include <sandbox/thread.hpp>
+#include <sandbox/topology.hpp>
+
+#include "core2corelatency.hpp"
+#include "results.hpp"
+#include "skew.hpp"
+
 extern "C" {
 uint64_t _thread_write_main(uint64_t cycle, uint64_t* read_ready, uint64_t* write_ready, uint64_t* data);
 uint64_t _thread_read_main(uint64_t cycle, uint64_t* read_ready, uint64_t* write_ready, uint64_t* data);
@@ -45,37 +58,10 @@ As an example in order to measure C2C latency between Core 1 and Core 2:
 */
 
 #define ITERATIONS 1000000
+#define REFINE_THRESHOLD 0.5
 #define USE_ATOMIC
 #define USE_ASSEMBLY
 
-void thread_affinity(uint16_t processor, uint8_t thread_index)
-{
-#ifdef WIN32
-	HANDLE         thread = GetCurrentThread();
-	GROUP_AFFINITY gaff   = {0};
-	gaff.Group            = processor;
-	gaff.Mask             = 0b1ull << thread_index;
-
-	PROCESSOR_NUMBER pn = {0};
-	pn.Group            = gaff.Group;
-	pn.Number           = thread_index;
-
-	SetThreadIdealProcessorEx(thread, &pn, nullptr);
-	SetThreadGroupAffinity(thread, &gaff, nullptr);
-#else
-	pthread_set_Affinity_np()
-#endif
-}
-
-void thread_priority_rt()
-{
-#ifdef WIN32
-	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
-	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
-#else
-#endif
-}
-
 struct thread_read_data {
 	volatile uint32_t id;
 #ifdef USE_ASSEMBLY
@@ -84,8 +70,12 @@ struct thread_read_data {
 	std::atomic<size_t>   ready;
 #endif
 
-	// Profiler storage
-	std::shared_ptr<xmr::utility::profiler::profiler> profiler;
+	// Histogram storage
+	sandbox::histogram histogram;
+
+	// Decides when we have enough samples, the write thread follows along.
+	std::shared_ptr<sandbox::sampler> sampler;
+	std::atomic<bool>                 stop;
 };
 
 struct thread_write_data {
@@ -106,8 +96,8 @@ struct thread_write_data {
 
 void thread_read_main(thread_read_data* td, thread_write_data* twd)
 {
-	thread_affinity(0, td->id);
-	thread_priority_rt();
+	sandbox::thread_affinity(0, td->id);
+	sandbox::thread_priority_rt();
 
 #ifndef USE_ASSEMBLY
 	std::atomic<size_t>& read_ready  = td->ready;
@@ -124,12 +114,15 @@ void thread_read_main(thread_read_data* td, thread_write_data* twd)
 #endif
 
 	read_ready = 0;
-	for (volatile size_t idx = 1; idx <= ITERATIONS; idx++) {
+	for (volatile size_t idx = 1; !td->stop; idx++) {
 #ifdef USE_ASSEMBLY
 		// Record time, store time, reset.
 		uint64_t time = _thread_read_main(idx, &(td->ready), &(twd->ready), &(twd->data));
-		td->profiler->track(time, data);
-		data = 0;
+		td->histogram.track(time - data);
+		td->sampler->add(time - data);
+		// Decide before releasing the write thread, so it sees the decision.
+		td->stop = td->sampler->done();
+		data     = 0;
 #else
         // Wait for write thread to be ready.
         while (write_ready != idx) { // no-op
@@ -141,7 +134,10 @@ void thread_read_main(thread_read_data* td, thread_write_data* twd)
         }
         // Record time and store.
         uint64_t time = xmr::utility::profiler::clock::tsc::now();
-        td->profiler->track(time, twd->time);
+        td->histogram.track(time - twd->time);
+        td->sampler->add(time - twd->time);
+        // Decide before releasing the write thread, so it sees the decision.
+        td->stop = td->sampler->done();
         // Reset data
         data = false;
 #endif
@@ -150,8 +146,8 @@ void thread_read_main(thread_read_data* td, thread_write_data* twd)
 
 void thread_write_main(thread_write_data* td, thread_read_data* trd)
 {
-	thread_affinity(0, td->id);
-	thread_priority_rt();
+	sandbox::thread_affinity(0, td->id);
+	sandbox::thread_priority_rt();
 
 #ifndef USE_ASSEMBLY
 	std::atomic<size_t>& read_ready  = trd->ready;
@@ -171,7 +167,7 @@ void thread_write_main(thread_write_data* td, thread_read_data* trd)
 	read_ready  = 0;
 	data        = false;
 
-	for (volatile size_t idx = 1; idx <= ITERATIONS; idx++) {
+	for (volatile size_t idx = 1; !trd->stop; idx++) {
 #ifdef USE_ASSEMBLY
 		uint64_t jdx = _thread_write_main(idx, &(trd->ready), &(td->ready), &(td->data));
 		jdx += 1;
@@ -191,43 +187,176 @@ void thread_write_main(thread_write_data* td, thread_read_data* trd)
 	}
 }
 
+// Measure all pairs of a round at the same time, each on its own physical cores, and append them to the results file.
+static void measure_round(const std::vector<std::pair<uint32_t, uint32_t>>& round, const sandbox::sampling_options& sampling,
+						  std::map<std::pair<uint32_t, uint32_t>, results_pair>& results, std::ofstream& results_file)
+{
+	// Create and initialize structures.
+	std::vector<std::unique_ptr<thread_read_data>>  trds;
+	std::vector<std::unique_ptr<thread_write_data>> twds;
+	for (auto& pair : round) {
+		auto trd     = std::make_unique<thread_read_data>();
+		auto twd     = std::make_unique<thread_write_data>();
+		trd->id      = pair.first;
+		trd->sampler = std::make_shared<sandbox::sampler>(sampling);
+		trd->stop    = false;
+		twd->id      = pair.second;
+		trds.push_back(std::move(trd));
+		twds.push_back(std::move(twd));
+	}
+
+	// Spawn all threads.
+	std::vector<std::thread> threads;
+	for (size_t n = 0; n < round.size(); n++) {
+		threads.emplace_back(thread_read_main, trds[n].get(), twds[n].get());
+		threads.emplace_back(thread_write_main, twds[n].get(), trds[n].get());
+	}
+
+	// Block by joining back together with the threads.
+	for (auto& thread : threads) {
+		if (thread.joinable())
+			thread.join();
+	}
+
+	// Insert measurements, probing the TSC offset of the reader relative to the writer one pair at a time as it is short.
+	double ns_per_tick = results_ns_per_tick();
+	for (size_t n = 0; n < round.size(); n++) {
+		auto skew = skew_probe(round[n].second, round[n].first);
+
+		results_pair result;
+		result.reader    = round[n].first;
+		result.writer    = round[n].second;
+		result.histogram = trds[n]->histogram;
+		result.precision = trds[n]->sampler->precision();
+		result.skew      = skew.offset * ns_per_tick;
+		result.rtt       = skew.rtt_median * ns_per_tick;
+		results_append(results_file, result);
+		results[round[n]] = result;
+	}
+}
+
 std::int32_t main(std::int32_t argc, const char* argv[])
 {
-	std::map<std::pair<uint32_t, uint32_t>, std::shared_ptr<xmr::utility::profiler::profiler>> profilers;
+	// Select the mode to run, defaulting to the flag ping-pong.
+	if (argc > 1) {
+		if (strcmp(argv[1], "bandwidth") == 0) {
+			return main_bandwidth(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "broadcast") == 0) {
+			return main_broadcast(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "layout") == 0) {
+			return main_layout(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "skew") == 0) {
+			return main_skew(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "spsc") == 0) {
+			return main_spsc(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "wakeup") == 0) {
+			return main_wakeup(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "latency") != 0) {
+			printf("Usage: %s [latency [physical|siblings|both] [concurrent] [resume|refine [threshold]] [target precision]|bandwidth|broadcast|layout|skew|spsc|wakeup]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// Measure until the median is known to within the target, or we hit the iteration limit.
+	sandbox::sampling_options sampling;
+	sampling.statistic   = sandbox::sampling_statistic::median;
+	sampling.target      = 0.01;
+	sampling.min_samples = ITERATIONS / 100;
+	sampling.max_samples = ITERATIONS;
+	sampling.interval    = ITERATIONS / 100;
+
+	// SMT siblings share L1 and L2, so they are labelled, or filtered out entirely.
+	// Resume skips pairs already in the results file, refine only repeats the noisy ones.
+	sandbox::topology_smt smt        = sandbox::topology_smt::both;
+	bool                  concurrent = false;
+	bool                  resume     = false;
+	bool                  refine     = false;
+	double                threshold  = REFINE_THRESHOLD;
+	for (std::int32_t n = 2; n < argc; n++) {
+		if (sandbox::topology_smt_parse(argv[n], smt)) {
+			continue;
+		} else if (strcmp(argv[n], "concurrent") == 0) {
+			concurrent = true;
+		} else if (strcmp(argv[n], "resume") == 0) {
+			resume = true;
+		} else if (strcmp(argv[n], "refine") == 0) {
+			refine = true;
+			if (((n + 1) < argc) && (strtod(argv[n + 1], nullptr) > 0)) {
+				threshold = strtod(argv[++n], nullptr);
+			}
+		} else if ((sampling.target = strtod(argv[n], nullptr)) <= 0) {
+			printf("Usage: %s latency [physical|siblings|both] [concurrent] [resume|refine [threshold]] [target precision]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// Concurrent pairs never share a physical core, otherwise each pair runs on its own.
+	auto     topology    = sandbox::topology_detect();
+	uint32_t max_core_id = uint32_t(topology.size());
+	auto     pairs       = sandbox::topology_pairs(topology, smt);
+	double   ns_per_tick = results_ns_per_tick();
+
+	// Every pair is written as soon as it is done, so an interrupted run loses at most one round.
+	std::map<std::pair<uint32_t, uint32_t>, results_pair> results;
+	std::ofstream                                         results_file;
+	if (resume || refine) {
+		if (!results_load("results.jsonl", "latency", results) || !results_reopen(results_file, "results.jsonl")) {
+			printf("Failed to load 'results.jsonl', nothing to %s.\n", resume ? "resume" : "refine");
+			return 1;
+		}
+
+		// Relative standard deviation, so the threshold works for fast and slow pairs alike.
+		auto skip = [&results, resume, threshold](const std::pair<uint32_t, uint32_t>& pair) {
+			auto itr = results.find(pair);
+			if (resume) {
+				return itr != results.end();
+			}
+			return (itr == results.end()) || ((std::sqrt(itr->second.histogram.variance()) / itr->second.histogram.average()) <= threshold);
+		};
+		pairs.erase(std::remove_if(pairs.begin(), pairs.end(), skip), pairs.end());
+		printf("Loaded %zu pairs from 'results.jsonl'.\n", results.size());
+	} else if (!results_open(results_file, "results.jsonl", "latency", ITERATIONS, topology)) {
+		printf("Failed to create 'results.jsonl'.\n");
+		return 1;
+	}
+
+	auto rounds = sandbox::topology_schedule(topology, pairs, concurrent ? 0 : 1);
+	printf("Measuring %zu pairs (%s) in %zu rounds...\n", pairs.size(), sandbox::topology_smt_name(smt), rounds.size());
+	for (auto& round : rounds) {
+		measure_round(round, sampling, results, results_file);
+	}
+	results_file.close();
+
+	printf("Average latency, and the relative %.0f%% confidence interval width of the median (target: %.2f%%). * marks SMT siblings.\n", sampling.confidence * 100.0, sampling.target * 100.0);
 
-	uint32_t max_core_id = std::thread::hardware_concurrency();
 	for (uint32_t idx = 0; idx < max_core_id; idx++) {
 		printf("%3" PRIu32 " |", idx);
 		for (uint32_t jdx = 0; jdx < max_core_id; jdx++) {
-			std::pair<uint32_t, uint32_t> key{idx, jdx};
-
-			// Skip identical cores, can't measure latency to self.
-			if (idx == jdx) {
-				printf("          |");
+			// Skip identical cores and filtered pairs.
+			auto value = results.find({idx, jdx});
+			if (value == results.end()) {
+				printf("                 |");
 				continue;
 			}
 
-			// Create and initialize structures.
-			thread_read_data  trd;
-			thread_write_data twd;
-			trd.id       = idx;
-			trd.profiler = std::make_shared<xmr::utility::profiler::profiler>();
-			twd.id       = jdx;
-
-			// Spawn both threads.
-			std::thread a(thread_read_main, &trd, &twd);
-			std::thread b(thread_write_main, &twd, &trd);
-
-			// Block by joining back together with the threads.
-			if (a.joinable())
-				a.join();
-			if (b.joinable())
-				b.join();
+			printf("%6.1f ns %5.2f%%%c|", value->second.histogram.average() * ns_per_tick, value->second.precision * 100.0,
+				   sandbox::topology_siblings(topology, idx, jdx) ? '*' : ' ');
+		}
+		printf("\n");
+	}
 
-			// Insert measurements
-			profilers.emplace(key, trd.profiler);
+	// The one-way average above includes any TSC offset between the two cores, these two do not.
+	printf("\nHalf the median round trip, and the one-way average corrected by the TSC offset.\n");
+	for (uint32_t idx = 0; idx < max_core_id; idx++) {
+		printf("%3" PRIu32 " |", idx);
+		for (uint32_t jdx = 0; jdx < max_core_id; jdx++) {
+			auto value = results.find({idx, jdx});
+			if (value == results.end()) {
+				printf("                 |");
+				continue;
+			}
 
-			printf("%6.1f ns |", xmr::utility::profiler::clock::tsc::to_nanoseconds(trd.profiler->average_time()));
+			printf("%6.1f %6.1f ns |", value->second.rtt / 2.0, value->second.histogram.average() * ns_per_tick - value->second.skew);
 		}
 		printf("\n");
 	}
@@ -251,9 +380,11 @@ std::int32_t main(std::int32_t argc, const char* argv[])
 					continue;
 				}
 
-				auto value = profilers.find(key);
-				if (value != profilers.end()) {
-					file << xmr::utility::profiler::clock::tsc::to_nanoseconds(value->second->average_time()) << ",";
+				auto value = results.find(key);
+				if (value != results.end()) {
+					file << value->second.histogram.average() * ns_per_tick << ",";
+				} else {
+					file << ",";
 				}
 			}
 			file << std::endl;
@@ -277,10 +408,11 @@ std::int32_t main(std::int32_t argc, const char* argv[])
 					continue;
 				}
 
-				auto value = profilers.find(key);
-				if (value != profilers.end()) {
-					file << xmr::utility::profiler::clock::tsc::to_nanoseconds(value->second->percentile_time(0.999))
-						 << ",";
+				auto value = results.find(key);
+				if (value != results.end()) {
+					file << double(value->second.histogram.percentile(0.999)) * ns_per_tick << ",";
+				} else {
+					file << ",";
 				}
 			}
 			file << std::endl;
@@ -304,10 +436,117 @@ std::int32_t main(std::int32_t argc, const char* argv[])
 					continue;
 				}
 
-				auto value = profilers.find(key);
-				if (value != profilers.end()) {
-					file << xmr::utility::profiler::clock::tsc::to_nanoseconds(value->second->percentile_time(0.99))
+				auto value = results.find(key);
+				if (value != results.end()) {
+					file << double(value->second.histogram.percentile(0.99)) * ns_per_tick << ",";
+				} else {
+					file << ",";
+				}
+			}
+			file << std::endl;
+		}
+		file << std::endl;
+	}
+	{ // Precision
+		file << "c2c"
+			 << ",";
+		for (size_t n = 0; n < max_core_id; n++) {
+			file << n << ",";
+		}
+		file << std::endl;
+		for (size_t n = 0; n < max_core_id; n++) {
+			file << n << ",";
+			for (size_t m = 0; m < max_core_id; m++) {
+				std::pair<uint32_t, uint32_t> key{n, m};
+				if (n == m) {
+					file << "x"
+						 << ",";
+					continue;
+				}
+
+				auto value = results.find(key);
+				if (value != results.end()) {
+					file << value->second.precision << ",";
+				} else {
+					file << ",";
+				}
+			}
+			file << std::endl;
+		}
+		file << std::endl;
+	}
+	{ // SMT siblings
+		file << "c2c"
+			 << ",";
+		for (size_t n = 0; n < max_core_id; n++) {
+			file << n << ",";
+		}
+		file << std::endl;
+		for (size_t n = 0; n < max_core_id; n++) {
+			file << n << ",";
+			for (size_t m = 0; m < max_core_id; m++) {
+				if (n == m) {
+					file << "x"
 						 << ",";
+					continue;
+				}
+
+				file << (sandbox::topology_siblings(topology, uint32_t(n), uint32_t(m)) ? 1 : 0) << ",";
+			}
+			file << std::endl;
+		}
+		file << std::endl;
+	}
+	{ // RTT/2
+		file << "c2c"
+			 << ",";
+		for (size_t n = 0; n < max_core_id; n++) {
+			file << n << ",";
+		}
+		file << std::endl;
+		for (size_t n = 0; n < max_core_id; n++) {
+			file << n << ",";
+			for (size_t m = 0; m < max_core_id; m++) {
+				std::pair<uint32_t, uint32_t> key{n, m};
+				if (n == m) {
+					file << "x"
+						 << ",";
+					continue;
+				}
+
+				auto value = results.find(key);
+				if (value != results.end()) {
+					file << value->second.rtt / 2.0 << ",";
+				} else {
+					file << ",";
+				}
+			}
+			file << std::endl;
+		}
+		file << std::endl;
+	}
+	{ // Corrected one-way average
+		file << "c2c"
+			 << ",";
+		for (size_t n = 0; n < max_core_id; n++) {
+			file << n << ",";
+		}
+		file << std::endl;
+		for (size_t n = 0; n < max_core_id; n++) {
+			file << n << ",";
+			for (size_t m = 0; m < max_core_id; m++) {
+				std::pair<uint32_t, uint32_t> key{n, m};
+				if (n == m) {
+					file << "x"
+						 << ",";
+					continue;
+				}
+
+				auto value = results.find(key);
+				if (value != results.end()) {
+					file << value->second.histogram.average() * ns_per_tick - value->second.skew << ",";
+				} else {
+					file << ",";
 				}
 			}
 			file << std::endl;
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+
+/* Render core2corelatency Results
+
+Reads a results.jsonl file written by core2corelatency and renders it into a
+single self-contained HTML file with inline SVG:
+- A heatmap per statistic (min, p50, p99, p99.99), reader on the vertical and
+  writer on the horizontal axis. Pairs of SMT siblings are outlined, as they
+  talk through a shared L1/L2 rather than across cores.
+- A CDF per pair, laid out in the same matrix as the heatmaps and sharing one
+  time axis, so outliers stand out at a glance.
+
+Usage: report [results.jsonl] [results.html]
+*/
+
+#define HEATMAP_SIZE 640
+#define CDF_CELL_WIDTH 96
+#define CDF_CELL_HEIGHT 48
+#define CDF_POINTS 64
+
+struct report_pair {
+	uint32_t                      reader;
+	uint32_t                      writer;
+	std::map<std::string, double> percentiles;
+	double                        min;
+
+	// Cumulative distribution as (nanoseconds, fraction) points.
+	std::vector<std::pair<double, double>> cdf;
+};
+
+static std::string html_escape(const std::string& value)
+{
+	std::string escaped;
+	for (char c : value) {
+		switch (c) {
+		case '<':
+			escaped += "&lt;";
+			break;
+		case '>':
+			escaped += "&gt;";
+			break;
+		case '&':
+			escaped += "&amp;";
+			break;
+		default:
+			escaped.push_back(c);
+			break;
+		}
+	}
+	return escaped;
+}
+
+// Map 0..1 to blue (fast) through green and yellow to red (slow).
+static std::string heat_color(double value)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "hsl(%.0f,80%%,50%%)", 240.0 * (1.0 - std::clamp(value, 0.0, 1.0)));
+	return buffer;
+}
+
+static void render_heatmap(std::ostream& out, const char* title, uint32_t cores, const std::map<std::pair<uint32_t, uint32_t>, double>& values,
+						   const std::set<std::pair<uint32_t, uint32_t>>& siblings)
+{
+	double lo = INFINITY, hi = -INFINITY;
+	for (auto& kv : values) {
+		lo = std::min(lo, kv.second);
+		hi = std::max(hi, kv.second);
+	}
+	double range = std::max(hi - lo, 1e-9);
+	double cell  = std::max(4.0, double(HEATMAP_SIZE) / double(std::max<uint32_t>(cores, 1)));
+
+	out << "<h2>" << title << "</h2>\n";
+	out << "<p>" << lo << " ns <span class=\"scale\"></span> " << hi << " ns</p>\n";
+	out << "<svg width=\"" << (cell * cores) << "\" height=\"" << (cell * cores) << "\">\n";
+	for (uint32_t reader = 0; reader < cores; reader++) {
+		for (uint32_t writer = 0; writer < cores; writer++) {
+			auto        itr   = values.find({reader, writer});
+			std::string color   = (itr != values.end()) ? heat_color((itr->second - lo) / range) : "#ccc";
+			bool        sibling = siblings.count({reader, writer}) != 0;
+			out << "<rect x=\"" << (writer * cell) << "\" y=\"" << (reader * cell) << "\" width=\"" << cell << "\" height=\"" << cell << "\" fill=\"" << color << "\"" << (sibling ? " class=\"sibling\"" : "") << ">";
+			if (itr != values.end()) {
+				out << "<title>" << reader << " &lt;- " << writer << ": " << itr->second << " ns" << (sibling ? " (SMT sibling)" : "") << "</title>";
+			}
+			out << "</rect>\n";
+		}
+	}
+	out << "</svg>\n";
+}
+
+static void render_cdfs(std::ostream& out, uint32_t cores, const std::map<std::pair<uint32_t, uint32_t>, report_pair>& pairs)
+{
+	// One shared axis, cut at the slowest p99.9 so a few outliers don't flatten everything.
+	double limit = 0;
+	for (auto& kv : pairs) {
+		auto itr = kv.second.percentiles.find("p99.9");
+		if (itr != kv.second.percentiles.end()) {
+			limit = std::max(limit, itr->second);
+		}
+	}
+	limit = std::max(limit, 1e-9);
+
+	out << "<h2>CDF per pair (0 to " << limit << " ns)</h2>\n";
+	out << "<svg width=\"" << (cores * CDF_CELL_WIDTH) << "\" height=\"" << (cores * CDF_CELL_HEIGHT) << "\">\n";
+	for (auto& kv : pairs) {
+		auto&  pair = kv.second;
+		double x0   = double(pair.writer) * CDF_CELL_WIDTH;
+		double y0 = double(pair.reader) * CDF_CELL_HEIGHT;
+		out << "<g transform=\"translate(" << x0 << "," << y0 << ")\">";
+		out << "<rect width=\"" << (CDF_CELL_WIDTH - 2) << "\" height=\"" << (CDF_CELL_HEIGHT - 2) << "\" class=\"cell\"/>";
+		out << "<polyline points=\"";
+		for (auto& point : pair.cdf) {
+			double x = std::min(point.first / limit, 1.0) * (CDF_CELL_WIDTH - 2);
+			double y = (1.0 - point.second) * (CDF_CELL_HEIGHT - 2);
+			out << x << "," << y << " ";
+		}
+		out << "\"/><title>" << pair.reader << " &lt;- " << pair.writer << "</title></g>\n";
+	}
+	out << "</svg>\n";
+}
+
+std::int32_t main(std::int32_t argc, const char* argv[])
+{
+	const char* input  = (argc > 1) ? argv[1] : "results.jsonl";
+	const char* output = (argc > 2) ? argv[2] : "results.html";
+
+	std::ifstream file(input);
+	if (!file.good()) {
+		printf("Usage: %s [results.jsonl] [results.html]\n", argv[0]);
+		return 1;
+	}
+
+	json_value                                           metadata;
+	std::map<std::pair<uint32_t, uint32_t>, report_pair> pairs;
+	size_t                                               skipped = 0;
+	std::string                                          line;
+	while (std::getline(file, line)) {
+		if (line.empty()) {
+			continue;
+		}
+
+		// Interrupted runs can leave a broken line behind.
+		json_value value;
+		try {
+			value = json_parser(line).parse();
+		} catch (const std::exception&) {
+			skipped++;
+			continue;
+		}
+
+		if (value["type"].string == "metadata") {
+			metadata = value;
+		} else if (value["type"].string == "pair") {
+			report_pair pair;
+			pair.reader = uint32_t(value["reader"].number);
+			pair.writer = uint32_t(value["writer"].number);
+			pair.min    = value["min"].number;
+			for (auto& kv : value["percentiles"].object) {
+				pair.percentiles[kv.first] = kv.second.number;
+			}
+
+			// Thin the histogram out to a fixed number of CDF points.
+			double ns_per_tick = metadata["ns_per_tick"].number;
+			auto&  ticks       = value["histogram"]["ticks"].array;
+			auto&  counts      = value["histogram"]["counts"].array;
+			double total       = value["count"].number;
+			double seen        = 0;
+			size_t step        = std::max<size_t>(1, ticks.size() / CDF_POINTS);
+			for (size_t n = 0; n < std::min(ticks.size(), counts.size()); n++) {
+				seen += counts[n].number;
+				if (((n % step) == 0) || ((n + 1) == ticks.size())) {
+					pair.cdf.push_back({ticks[n].number * ns_per_tick, seen / total});
+				}
+			}
+
+			// Later lines for the same pair replace earlier ones.
+			pairs[{pair.reader, pair.writer}] = pair;
+		}
+	}
+	if (skipped > 0) {
+		printf("Skipped %zu unreadable lines in '%s'.\n", skipped, input);
+	}
+
+	uint32_t cores = uint32_t(metadata["logical_processors"].number);
+	for (auto& kv : pairs) {
+		cores = std::max(cores, std::max(kv.first.first, kv.first.second) + 1);
+	}
+
+	// Processors on the same physical core are SMT siblings.
+	std::set<std::pair<uint32_t, uint32_t>> siblings;
+	auto&                                   topology = metadata["topology"].array;
+	for (auto& a : topology) {
+		for (auto& b : topology) {
+			if ((a["id"].number != b["id"].number) && (a["core"].number == b["core"].number)) {
+				siblings.insert({uint32_t(a["id"].number), uint32_t(b["id"].number)});
+			}
+		}
+	}
+
+	std::ofstream out(output, std::ios_base::out | std::ios_base::trunc);
+	out << "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>core2corelatency</title><style>\n";
+	out << "body{font-family:sans-serif} td{padding:0 1em 0 0} .cell{fill:#f8f8f8;stroke:#ddd} polyline{fill:none;stroke:#c33;stroke-width:1} .sibling{stroke:#000;stroke-width:2}\n";
+	out << ".scale{display:inline-block;width:200px;height:10px;background:linear-gradient(to right,hsl(240,80%,50%),hsl(120,80%,50%),hsl(0,80%,50%))}\n";
+	out << "</style></head><body>\n<h1>core2corelatency</h1>\n<table>\n";
+	for (const char* key : {"mode", "hostname", "os", "cpu", "timestamp"}) {
+		out << "<tr><td>" << key << "</td><td>" << html_escape(metadata[key].string) << "</td></tr>\n";
+	}
+	out << "<tr><td>logical processors</td><td>" << metadata["logical_processors"].number << "</td></tr>\n";
+	out << "<tr><td>iterations</td><td>" << metadata["iterations"].number << "</td></tr>\n";
+	out << "</table>\n";
+
+	for (const char* key : {"min", "p50", "p99", "p99.99"}) {
+		std::map<std::pair<uint32_t, uint32_t>, double> values;
+		for (auto& kv : pairs) {
+			values[kv.first] = (strcmp(key, "min") == 0) ? kv.second.min : kv.second.percentiles[key];
+		}
+		render_heatmap(out, key, cores, values, siblings);
+	}
+	render_cdfs(out, cores, pairs);
+
+	out << "</body></html>\n";
+	out.close();
+
+	printf("Rendered %zu pairs from '%s' to '%s'.\n", pairs.size(), input, output);
+	return 0;
+}
@@ -0,0 +1,201 @@
+#include "results.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <vector>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#include <sandbox/cpuid.hpp>
+
+#include "json.hpp"
+
+const double results_percentiles[11] = {0.01, 0.05, 0.10, 0.25, 0.50, 0.75, 0.90, 0.95, 0.99, 0.999, 0.9999};
+
+static std::string json_escape(const std::string& value)
+{
+	std::string escaped;
+	for (char c : value) {
+		if ((c == '"') || (c == '\\')) {
+			escaped.push_back('\\');
+			escaped.push_back(c);
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			escaped.push_back(' ');
+		} else {
+			escaped.push_back(c);
+		}
+	}
+	return escaped;
+}
+
+static std::string system_hostname()
+{
+	char buffer[256] = {0};
+#ifdef WIN32
+	DWORD length = sizeof(buffer);
+	if (!GetComputerNameA(buffer, &length)) {
+		return "unknown";
+	}
+#else
+	if (gethostname(buffer, sizeof(buffer) - 1) != 0) {
+		return "unknown";
+	}
+#endif
+	return buffer;
+}
+
+double results_ns_per_tick()
+{
+	return xmr::utility::profiler::clock::tsc::to_nanoseconds(1000000000.0) / 1000000000.0;
+}
+
+bool results_open(std::ofstream& file, const std::string& path, const char* mode, uint64_t iterations, const std::vector<sandbox::topology_processor>& topology)
+{
+	file.open(path, std::ios_base::out | std::ios_base::trunc);
+	if (!file.good()) {
+		return false;
+	}
+
+	char        timestamp[32] = {0};
+	std::time_t now           = std::time(nullptr);
+	std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+	file << std::setprecision(10);
+	file << "{\"type\":\"metadata\",\"format\":\"core2corelatency\",\"version\":" << RESULTS_FORMAT_VERSION;
+	file << ",\"mode\":\"" << json_escape(mode) << "\"";
+	file << ",\"hostname\":\"" << json_escape(system_hostname()) << "\"";
+#ifdef WIN32
+	file << ",\"os\":\"windows\"";
+#else
+	file << ",\"os\":\"linux\"";
+#endif
+	file << ",\"cpu\":\"" << json_escape(sandbox::cpuid_brand()) << "\"";
+	file << ",\"logical_processors\":" << topology.size();
+	file << ",\"iterations\":" << iterations;
+	file << ",\"ns_per_tick\":" << results_ns_per_tick();
+	file << ",\"timestamp\":\"" << timestamp << "\"";
+	file << ",\"topology\":[";
+	for (size_t n = 0; n < topology.size(); n++) {
+		file << (n > 0 ? "," : "") << "{\"id\":" << topology[n].id << ",\"core\":" << topology[n].core << ",\"l3\":" << topology[n].l3 << ",\"package\":" << topology[n].package << ",\"node\":" << topology[n].node << "}";
+	}
+	file << "]}" << std::endl;
+
+	return file.good();
+}
+
+bool results_reopen(std::ofstream& file, const std::string& path)
+{
+	// Terminate any half written line, so it does not swallow the next pair.
+	bool terminated = true;
+	{
+		std::ifstream existing(path, std::ios_base::in | std::ios_base::binary);
+		if (existing.good() && existing.seekg(-1, std::ios_base::end)) {
+			terminated = existing.get() == '\n';
+		}
+	}
+
+	file.open(path, std::ios_base::out | std::ios_base::app);
+	if (!terminated) {
+		file << std::endl;
+	}
+	file << std::setprecision(10);
+	return file.good();
+}
+
+void results_append(std::ofstream& file, const results_pair& pair)
+{
+	double ns_per_tick = results_ns_per_tick();
+
+	const sandbox::histogram& histogram = pair.histogram;
+	file << "{\"type\":\"pair\",\"reader\":" << pair.reader << ",\"writer\":" << pair.writer;
+	file << ",\"count\":" << histogram.count();
+	file << ",\"min\":" << double(histogram.min()) * ns_per_tick;
+	file << ",\"max\":" << double(histogram.max()) * ns_per_tick;
+	file << ",\"average\":" << histogram.average() * ns_per_tick;
+	file << ",\"variance\":" << histogram.variance() * ns_per_tick * ns_per_tick;
+	if (pair.precision >= 0) {
+		file << ",\"precision\":" << pair.precision;
+	}
+	if (std::isfinite(pair.skew)) {
+		file << ",\"skew\":" << pair.skew;
+	}
+	if (std::isfinite(pair.rtt)) {
+		file << ",\"rtt\":" << pair.rtt;
+	}
+	file << ",\"percentiles\":{";
+	for (size_t n = 0; n < std::size(results_percentiles); n++) {
+		file << (n > 0 ? "," : "") << "\"p" << results_percentiles[n] * 100.0 << "\":" << double(histogram.percentile(results_percentiles[n])) * ns_per_tick;
+	}
+	file << "},\"histogram\":{\"ticks\":[";
+	bool first = true;
+	for (auto kv : histogram.buckets()) {
+		file << (first ? "" : ",") << kv.first;
+		first = false;
+	}
+	file << "],\"counts\":[";
+	first = true;
+	for (auto kv : histogram.buckets()) {
+		file << (first ? "" : ",") << kv.second;
+		first = false;
+	}
+	file << "]}}" << std::endl;
+}
+
+bool results_load(const std::string& path, const char* mode, std::map<std::pair<uint32_t, uint32_t>, results_pair>& pairs)
+{
+	std::ifstream file(path);
+	if (!file.good()) {
+		return false;
+	}
+
+	bool        found = false;
+	std::string line;
+	while (std::getline(file, line)) {
+		// An interrupted run may have left half a line behind.
+		json_value value;
+		try {
+			value = json_parser(line).parse();
+		} catch (const std::exception&) {
+			continue;
+		}
+
+		if (value["type"].string == "metadata") {
+			if ((value["format"].string != "core2corelatency") || (value["mode"].string != mode)) {
+				return false;
+			}
+			found = true;
+		} else if (value["type"].string == "pair") {
+			results_pair pair;
+			pair.reader = uint32_t(value["reader"].number);
+			pair.writer = uint32_t(value["writer"].number);
+			if (value["precision"].kind == json_value::type::number) {
+				pair.precision = value["precision"].number;
+			}
+			if (value["skew"].kind == json_value::type::number) {
+				pair.skew = value["skew"].number;
+			}
+			if (value["rtt"].kind == json_value::type::number) {
+				pair.rtt = value["rtt"].number;
+			}
+
+			auto& ticks  = value["histogram"]["ticks"].array;
+			auto& counts = value["histogram"]["counts"].array;
+			for (size_t n = 0; n < std::min(ticks.size(), counts.size()); n++) {
+				pair.histogram.track(uint64_t(ticks[n].number), uint64_t(counts[n].number));
+			}
+
+			pairs[{pair.reader, pair.writer}] = pair;
+		}
+	}
+	return found;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cinttypes>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sandbox/histogram.hpp>
+#include <sandbox/topology.hpp>
+
+/* Results File
+
+Full distributions for every measured pair, as JSON Lines: one self-contained
+JSON object per line, so that the file can be appended to pair by pair and
+read back without a streaming parser.
+
+The first line is the metadata:
+  {"type":"metadata","format":"core2corelatency","version":1,"mode":"latency",
+   "hostname":"...","os":"...","cpu":"...","logical_processors":N,
+   "iterations":N,"ns_per_tick":X,"timestamp":"...","topology":[
+   {"id":0,"core":0,"l3":0,"package":0,"node":0},...]}
+
+Every following line is a pair, with all times in nanoseconds except for the
+histogram, which is kept in exact TSC ticks. Precision is the relative width of
+the confidence interval the sampler reached, skew is the reader's TSC minus the
+writer's TSC and rtt is the median round trip time of the skew probe. Each of
+them is only present if known:
+  {"type":"pair","reader":0,"writer":1,"count":N,"min":X,"max":X,"average":X,
+   "variance":X,"precision":X,"skew":X,"rtt":X,
+   "percentiles":{"p1":X,...,"p99.99":X},
+   "histogram":{"ticks":[...],"counts":[...]}}
+
+Every pair is appended as soon as it has been measured, so an interrupted run
+can be resumed. A pair may appear more than once, in which case the last line
+wins.
+*/
+
+#define RESULTS_FORMAT_VERSION 1
+
+// Percentiles written for every pair, as fractions.
+extern const double results_percentiles[11];
+
+// Start a new results file, writing the metadata line.
+bool results_open(std::ofstream& file, const std::string& path, const char* mode, uint64_t iterations, const std::vector<sandbox::topology_processor>& topology);
+
+// A single pair, as written and read back. Skew and round trip time are in nanoseconds.
+struct results_pair {
+	uint32_t           reader;
+	uint32_t           writer;
+	sandbox::histogram histogram;
+	double             precision = -1;  // Negative if unknown.
+	double             skew      = NAN; // NaN if unknown.
+	double             rtt       = NAN; // NaN if unknown.
+};
+
+// Continue an existing results file, appending to it.
+bool results_reopen(std::ofstream& file, const std::string& path);
+
+// Append a single pair to the results file, and flush it.
+void results_append(std::ofstream& file, const results_pair& pair);
+
+// Read all pairs back from a results file written by the given mode, keeping the last line of every pair.
+bool results_load(const std::string& path, const char* mode, std::map<std::pair<uint32_t, uint32_t>, results_pair>& pairs);
+
+// Conversion factor from TSC ticks to nanoseconds.
+double results_ns_per_tick();
@@ -0,0 +1,134 @@
+#include "skew.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#include <sandbox/thread.hpp>
+
+#include "core2corelatency.hpp"
+#include "results.hpp"
+
+#define SKEW_ROUND_TRIPS 10000
+#define CACHE_LINE_SIZE 64
+
+struct skew_data {
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> request;
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> response;
+	std::atomic<uint64_t> time;
+
+	uint32_t origin;
+	uint32_t target;
+
+	std::vector<std::pair<uint64_t, double>> samples; // Round trip time and offset estimate.
+};
+
+static void skew_origin_main(skew_data* sd)
+{
+	sandbox::thread_affinity(0, sd->origin);
+	sandbox::thread_priority_rt();
+
+	for (uint64_t idx = 1; idx <= SKEW_ROUND_TRIPS; idx++) {
+		// Record time and send the request.
+		uint64_t t0 = xmr::utility::profiler::clock::tsc::now();
+		sd->request.store(idx, std::memory_order_release);
+
+		// Wait for the reply and record time.
+		while (sd->response.load(std::memory_order_acquire) != idx) { // no-op
+		}
+		uint64_t t1 = xmr::utility::profiler::clock::tsc::now();
+		uint64_t tb = sd->time.load(std::memory_order_relaxed);
+
+		sd->samples[idx - 1] = {t1 - t0, double(tb) - (double(t0) + double(t1)) / 2.0};
+	}
+}
+
+static void skew_target_main(skew_data* sd)
+{
+	sandbox::thread_affinity(0, sd->target);
+	sandbox::thread_priority_rt();
+
+	for (uint64_t idx = 1; idx <= SKEW_ROUND_TRIPS; idx++) {
+		// Wait for the request, and reply with our time.
+		while (sd->request.load(std::memory_order_acquire) != idx) { // no-op
+		}
+		sd->time.store(xmr::utility::profiler::clock::tsc::now(), std::memory_order_relaxed);
+		sd->response.store(idx, std::memory_order_release);
+	}
+}
+
+skew_result skew_probe(uint32_t origin, uint32_t target)
+{
+	// Create and initialize structures.
+	skew_data sd;
+	sd.request  = 0;
+	sd.response = 0;
+	sd.time     = 0;
+	sd.origin   = origin;
+	sd.target   = target;
+	sd.samples.resize(SKEW_ROUND_TRIPS);
+
+	// Spawn both threads.
+	std::thread a(skew_origin_main, &sd);
+	std::thread b(skew_target_main, &sd);
+
+	// Block by joining back together with the threads.
+	if (a.joinable())
+		a.join();
+	if (b.joinable())
+		b.join();
+
+	std::sort(sd.samples.begin(), sd.samples.end());
+
+	skew_result result;
+	result.offset     = sd.samples.front().second;
+	result.rtt_min    = double(sd.samples.front().first);
+	result.rtt_median = double(sd.samples[sd.samples.size() / 2].first);
+	return result;
+}
+
+std::int32_t main_skew(std::int32_t argc, const char* argv[])
+{
+	uint32_t max_core_id = std::thread::hardware_concurrency();
+	uint32_t origin      = 0;
+	if (argc > 1) {
+		origin = uint32_t(strtoul(argv[1], nullptr, 10));
+	}
+	if (origin >= max_core_id) {
+		printf("Usage: skew [origin=0]\n");
+		return 1;
+	}
+
+	double ns_per_tick = results_ns_per_tick();
+
+	std::ofstream file("skew.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "origin,target,offset,uncertainty,rtt min,rtt median" << std::endl;
+
+	printf("Probing the TSC offset of every core relative to core %" PRIu32 " with %" PRIu64 " round trips...\n", origin, uint64_t(SKEW_ROUND_TRIPS));
+	printf("Core | Offset      | +/-         | RTT (min)   | RTT (50%%)\n");
+	printf("-----+-------------+-------------+-------------+------------\n");
+	for (uint32_t idx = 0; idx < max_core_id; idx++) {
+		// Skip the origin, it has no offset to itself.
+		if (idx == origin) {
+			continue;
+		}
+
+		// The offset may be negative, so convert with the factor rather than the unsigned clock helpers.
+		auto   r           = skew_probe(origin, idx);
+		double offset      = r.offset * ns_per_tick;
+		double uncertainty = r.rtt_min * ns_per_tick / 2.0;
+		double rtt_min     = r.rtt_min * ns_per_tick;
+		double rtt_median  = r.rtt_median * ns_per_tick;
+		printf("%4" PRIu32 " | %8.1f ns | %8.1f ns | %8.1f ns | %8.1f ns\n", idx, offset, uncertainty, rtt_min, rtt_median);
+		file << origin << "," << idx << "," << offset << "," << uncertainty << "," << rtt_min << "," << rtt_median << std::endl;
+	}
+	file.close();
+
+	return 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cinttypes>
+
+/* TSC Skew Probe
+
+The latency mode subtracts a TSC value read on the writer core from one read on
+the reader core, so any offset between the two counters ends up in the result.
+
+The probe estimates that offset with a round trip, like NTP does:
+- The origin records t0 and sends a request.
+- The target records its own time tb and replies with it.
+- The origin records t1 once the reply arrives.
+- If both directions took equally long, the target read tb at (t0 + t1) / 2 of
+  the origin's clock, so the offset is tb - (t0 + t1) / 2.
+
+The round trip with the lowest time is the one least disturbed by anything
+else, so its estimate is kept. Any asymmetry between the directions still ends
+up in the offset, but it is bounded by half of that round trip time.
+*/
+
+struct skew_result {
+	double offset;     // Target TSC minus origin TSC, in ticks.
+	double rtt_min;    // Fastest round trip, in ticks.
+	double rtt_median; // Median round trip, in ticks.
+};
+
+// Estimate the TSC offset of the target processor relative to the origin processor.
+skew_result skew_probe(uint32_t origin, uint32_t target);
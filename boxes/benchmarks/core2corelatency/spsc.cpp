@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+#include <xmr/utility/profiler/profiler.hpp>
+
+#include <sandbox/optimize.hpp>
+#include <sandbox/thread.hpp>
+
+#include "core2corelatency.hpp"
+#include "spsc_ring.hpp"
+
+/* Measure SPSC Queue Throughput
+
+Pipeline stages hand messages to each other through single producer, single
+consumer queues, which behave quite differently from a single flag: messages
+are batched, and the index lines only move when a batch is published.
+
+For every pair of cores and every message size:
+- The writer reserves up to a batch of slots, stamps each message with the
+  current time, fills its payload and publishes the batch.
+- The reader acquires up to a batch of slots, reads each message in full and
+  records the time since it was stamped.
+- Repeat until N messages have been sent.
+
+Throughput is the number of messages over the time from the first send to the
+last receive, with the writer running flat out. A writer that runs flat out
+keeps the ring full, so its messages mostly measure time spent queued behind
+each other. Latency is therefore taken from a second, paced run in which the
+writer only sends once the reader has handed back the previous message.
+*/
+
+#define SPSC_MESSAGES 1000000
+#define SPSC_PACED_MESSAGES 100000
+#define SPSC_CAPACITY 1024
+#define SPSC_BATCH 16
+
+struct spsc_data {
+	uint32_t reader;
+	uint32_t writer;
+	size_t   message_size;
+	size_t   messages;
+	bool     paced; // One message in flight at a time.
+
+	std::unique_ptr<spsc_ring> ring;
+
+	uint64_t              start;
+	uint64_t              end;
+	std::vector<uint32_t> samples;
+};
+
+static void spsc_read_main(spsc_data* sd)
+{
+	sandbox::thread_affinity(0, sd->reader);
+	sandbox::thread_priority_rt();
+
+	spsc_ring& ring = *sd->ring;
+	for (size_t idx = 0; idx < sd->messages;) {
+		size_t count = ring.acquire(SPSC_BATCH);
+		for (size_t n = 0; n < count; n++) {
+			const uint64_t* message = reinterpret_cast<const uint64_t*>(ring.read_slot(n));
+
+			// Read the whole message, as a real consumer would.
+			uint64_t sum = 0;
+			for (size_t m = 1; m < (sd->message_size / sizeof(uint64_t)); m++) {
+				sum += message[m];
+			}
+			sandbox::do_not_optimize(sum);
+
+			// Record time since it was sent.
+			uint64_t time = xmr::utility::profiler::clock::tsc::now();
+
+			sd->samples[idx + n] = uint32_t(std::min<uint64_t>(time - message[0], UINT32_MAX));
+		}
+		ring.release(count);
+		idx += count;
+	}
+	sd->end = xmr::utility::profiler::clock::tsc::now();
+}
+
+static void spsc_write_main(spsc_data* sd)
+{
+	sandbox::thread_affinity(0, sd->writer);
+	sandbox::thread_priority_rt();
+
+	spsc_ring& ring = *sd->ring;
+	sd->start       = xmr::utility::profiler::clock::tsc::now();
+	for (size_t idx = 0; idx < sd->messages;) {
+		if (sd->paced) {
+			// Wait until the reader has released the previous message, so nothing is ever queued.
+			while (ring.reserve(SPSC_CAPACITY) != SPSC_CAPACITY) {
+			}
+		}
+
+		size_t count = ring.reserve(std::min<size_t>(sd->paced ? 1 : SPSC_BATCH, sd->messages - idx));
+		for (size_t n = 0; n < count; n++) {
+			uint64_t* message = reinterpret_cast<uint64_t*>(ring.write_slot(n));
+
+			// Fill the payload, then stamp it.
+			for (size_t m = 1; m < (sd->message_size / sizeof(uint64_t)); m++) {
+				message[m] = idx + n;
+			}
+			message[0] = xmr::utility::profiler::clock::tsc::now();
+		}
+		ring.publish(count);
+		idx += count;
+	}
+}
+
+static void spsc_run(spsc_data* sd)
+{
+	sd->ring  = std::make_unique<spsc_ring>(SPSC_CAPACITY, sd->message_size);
+	sd->start = 0;
+	sd->end   = 0;
+	sd->samples.assign(sd->messages, 0);
+
+	// Spawn both threads.
+	std::thread a(spsc_read_main, sd);
+	std::thread b(spsc_write_main, sd);
+
+	// Block by joining back together with the threads.
+	if (a.joinable())
+		a.join();
+	if (b.joinable())
+		b.join();
+}
+
+std::int32_t main_spsc(std::int32_t argc, const char* argv[])
+{
+	// Message sizes are given in bytes, and always hold at least the time stamp.
+	std::vector<size_t> sizes;
+	for (std::int32_t n = 1; n < argc; n++) {
+		size_t size = strtoull(argv[n], nullptr, 10);
+		if (size == 0) {
+			printf("Usage: spsc [message size in bytes...]\n");
+			return 1;
+		}
+		sizes.push_back(std::max(sizeof(uint64_t), (size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1)));
+	}
+	if (sizes.empty()) {
+		sizes = {8, 64, 256, 1024};
+	}
+
+	std::ofstream file("spsc.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "reader,writer,message size,messages/s,p50,p99" << std::endl;
+
+	uint32_t max_core_id = std::thread::hardware_concurrency();
+	printf("Sending %" PRIu64 " messages in batches of %" PRIu64 " through %" PRIu64 " slots, then %" PRIu64 " one at a time for latency...\n", uint64_t(SPSC_MESSAGES),
+		   uint64_t(SPSC_BATCH), uint64_t(SPSC_CAPACITY), uint64_t(SPSC_PACED_MESSAGES));
+	printf("Read | Write |  Size | Mmsg/s   | 50.00%%      | 99.00%%\n");
+	printf("-----+-------+-------+----------+-------------+------------\n");
+	for (uint32_t idx = 0; idx < max_core_id; idx++) {
+		for (uint32_t jdx = 0; jdx < max_core_id; jdx++) {
+			// Skip identical cores, a queue to self never leaves the core.
+			if (idx == jdx) {
+				continue;
+			}
+
+			for (size_t size : sizes) {
+				// Throughput with the writer running flat out.
+				spsc_data sd;
+				sd.reader       = idx;
+				sd.writer       = jdx;
+				sd.message_size = size;
+				sd.messages     = SPSC_MESSAGES;
+				sd.paced        = false;
+				spsc_run(&sd);
+				double rate = double(SPSC_MESSAGES) / xmr::utility::profiler::clock::tsc::to_nanoseconds(double(sd.end - sd.start)) * 1000000000.0;
+
+				// Latency with one message in flight.
+				sd.messages = SPSC_PACED_MESSAGES;
+				sd.paced    = true;
+				spsc_run(&sd);
+
+				auto profiler = std::make_shared<xmr::utility::profiler::profiler>();
+				for (uint32_t sample : sd.samples) {
+					profiler->track(sample, 0);
+				}
+
+				double p50 = xmr::utility::profiler::clock::tsc::to_nanoseconds(profiler->percentile_events(0.50));
+				double p99 = xmr::utility::profiler::clock::tsc::to_nanoseconds(profiler->percentile_events(0.99));
+				printf("%4" PRIu32 " | %5" PRIu32 " | %5zu | %8.3f | %8.1f ns | %8.1f ns\n", idx, jdx, size, rate / 1000000.0, p50, p99);
+				file << idx << "," << jdx << "," << size << "," << rate << "," << p50 << "," << p99 << std::endl;
+			}
+		}
+	}
+	file.close();
+
+	return 0;
+}
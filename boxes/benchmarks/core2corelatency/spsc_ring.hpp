@@ -0,0 +1,96 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+
+/* Single Producer, Single Consumer Ring
+
+A bounded ring of fixed size slots, each padded to whole cache lines so that a
+slot being written never shares a line with a slot being read.
+
+Each side keeps a private copy of the other side's index, and only reloads the
+shared one when the copy says the ring is full (producer) or empty (consumer).
+The shared index lines therefore only move between cores when they have to.
+
+Both sides work in batches: reserve/acquire return how many slots are usable,
+and publish/release hand over all of them with a single store.
+*/
+
+class spsc_ring {
+	static constexpr size_t cache_line = 64;
+
+	// Producer line: written by the producer, read by the consumer.
+	alignas(cache_line) std::atomic<size_t> _head;
+	size_t _tail_cache;
+
+	// Consumer line: written by the consumer, read by the producer.
+	alignas(cache_line) std::atomic<size_t> _tail;
+	size_t _head_cache;
+
+	// Read-only after construction.
+	alignas(cache_line) size_t _capacity;
+	size_t                  _slot_size;
+	std::unique_ptr<char[]> _storage;
+	char*                   _slots;
+
+	public:
+	// Capacity must be a power of two.
+	spsc_ring(size_t capacity, size_t message_size)
+		: _head(0), _tail_cache(0), _tail(0), _head_cache(0), _capacity(capacity),
+		  _slot_size((message_size + cache_line - 1) & ~(cache_line - 1))
+	{
+		_storage.reset(new char[_capacity * _slot_size + cache_line]);
+		_slots = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(_storage.get()) + cache_line - 1) & ~uintptr_t(cache_line - 1));
+	}
+
+	size_t slot_size() const
+	{
+		return _slot_size;
+	}
+
+	// Producer: Number of slots that can be written, up to count.
+	size_t reserve(size_t count)
+	{
+		size_t head = _head.load(std::memory_order_relaxed);
+		if ((_capacity - (head - _tail_cache)) < count) {
+			_tail_cache = _tail.load(std::memory_order_acquire);
+		}
+		return std::min(count, _capacity - (head - _tail_cache));
+	}
+
+	// Producer: The index-th reserved slot.
+	char* write_slot(size_t index)
+	{
+		return _slots + ((_head.load(std::memory_order_relaxed) + index) & (_capacity - 1)) * _slot_size;
+	}
+
+	// Producer: Make the first count reserved slots visible to the consumer.
+	void publish(size_t count)
+	{
+		_head.store(_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	// Consumer: Number of slots that can be read, up to count.
+	size_t acquire(size_t count)
+	{
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		if ((_head_cache - tail) < count) {
+			_head_cache = _head.load(std::memory_order_acquire);
+		}
+		return std::min(count, _head_cache - tail);
+	}
+
+	// Consumer: The index-th acquired slot.
+	const char* read_slot(size_t index)
+	{
+		return _slots + ((_tail.load(std::memory_order_relaxed) + index) & (_capacity - 1)) * _slot_size;
+	}
+
+	// Consumer: Hand the first count acquired slots back to the producer.
+	void release(size_t count)
+	{
+		_tail.store(_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+};
@@ -0,0 +1,436 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+#include <xmr/utility/profiler/profiler.hpp>
+
+#include <sandbox/pool.hpp>
+#include <sandbox/thread.hpp>
+
+#include "core2corelatency.hpp"
+
+/* Measure Blocking Wake-Up Latency
+
+Spinning is the fastest way to wait for another core, but thread pools and
+semaphores put their threads to sleep instead. Waking a sleeping thread goes
+through the kernel, and the sleeping core may have dropped into a deep idle
+state which takes a while to leave again.
+
+For every pair of cores and every mechanism:
+- The reader announces that it is about to wait, and blocks.
+- The writer waits a fixed delay, so the reader is really asleep.
+- The writer records time and wakes the reader.
+- The reader records time once it runs again.
+- Repeat for N iterations.
+
+The semaphore and thread pool are the ones from sandbox. The pool gets a single
+worker, which its first task moves onto the reader core, and every wake-up is a
+task posted to it.
+
+The idle state is the one the reader core entered most often during the run,
+taken from the cpuidle usage counters. It only exists on Linux.
+*/
+
+#define WAKEUP_ITERATIONS 2000
+#define WAKEUP_DELAY_US 50
+#define CACHE_LINE_SIZE 64
+
+enum class wakeup_mechanism {
+	spin,       // Baseline: spin on the same flag the other mechanisms block on.
+	futex,      // futex on Linux, WaitOnAddress on Windows.
+	condvar,    // std::condition_variable.
+	semaphore,  // sandbox::semaphore.
+	threadpool, // A task posted to a sandbox::thread_pool with one worker.
+#ifndef WIN32
+	eventfd,    // Blocking read from an eventfd.
+	pipe,       // Blocking read from a pipe.
+#endif
+};
+
+static const wakeup_mechanism wakeup_mechanisms[] = {
+	wakeup_mechanism::spin,
+	wakeup_mechanism::futex,
+	wakeup_mechanism::condvar,
+	wakeup_mechanism::semaphore,
+	wakeup_mechanism::threadpool,
+#ifndef WIN32
+	wakeup_mechanism::eventfd,
+	wakeup_mechanism::pipe,
+#endif
+};
+
+static const char* wakeup_mechanism_name(wakeup_mechanism mechanism)
+{
+	switch (mechanism) {
+	case wakeup_mechanism::spin:
+		return "spin";
+	case wakeup_mechanism::futex:
+		return "futex";
+	case wakeup_mechanism::condvar:
+		return "condvar";
+	case wakeup_mechanism::semaphore:
+		return "semaphore";
+	case wakeup_mechanism::threadpool:
+		return "threadpool";
+#ifndef WIN32
+	case wakeup_mechanism::eventfd:
+		return "eventfd";
+	case wakeup_mechanism::pipe:
+		return "pipe";
+#endif
+	}
+	return "unknown";
+}
+
+struct wakeup_data;
+
+// One task per wake-up, as the pool worker still writes to a task after running it.
+struct wakeup_task : sandbox::thread_task {
+	wakeup_data* wd  = nullptr;
+	uint64_t     idx = 0;
+
+	virtual bool work() override;
+};
+
+struct wakeup_data {
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> armed;
+	alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> word;
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> time;
+
+	uint32_t         reader;
+	uint32_t         writer;
+	wakeup_mechanism mechanism;
+	uint32_t         delay_us;
+
+	std::mutex              mutex;
+	std::condition_variable condition;
+	bool                    signalled;
+
+	sandbox::semaphore                    semaphore;
+	std::unique_ptr<sandbox::thread_pool> pool;
+	std::vector<wakeup_task>              tasks;
+
+#ifndef WIN32
+	int event;
+	int pipe[2];
+#endif
+
+	// Profiler storage
+	std::shared_ptr<xmr::utility::profiler::profiler> profiler;
+};
+
+bool wakeup_task::work()
+{
+	if (idx == 0) {
+		// The first task only moves the worker onto the reader core.
+		sandbox::thread_affinity(0, wd->reader);
+		sandbox::thread_priority_rt();
+	} else {
+		// Record time and store.
+		uint64_t now = xmr::utility::profiler::clock::tsc::now();
+		wd->profiler->track(now, wd->time.load(std::memory_order_acquire));
+	}
+
+	// The worker blocks on the pool's semaphore again right after this.
+	wd->armed.store(idx + 1, std::memory_order_release);
+	return true;
+}
+
+static void wakeup_wait(wakeup_data* wd)
+{
+	switch (wd->mechanism) {
+	case wakeup_mechanism::spin:
+		while (wd->word.load(std::memory_order_acquire) == 0) { // no-op
+		}
+		wd->word.store(0, std::memory_order_relaxed);
+		break;
+	case wakeup_mechanism::futex:
+		while (wd->word.load(std::memory_order_acquire) == 0) {
+#ifdef WIN32
+			uint32_t expected = 0;
+			WaitOnAddress(&wd->word, &expected, sizeof(expected), INFINITE);
+#else
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(&wd->word), FUTEX_WAIT_PRIVATE, 0, nullptr, nullptr, 0);
+#endif
+		}
+		wd->word.store(0, std::memory_order_relaxed);
+		break;
+	case wakeup_mechanism::condvar: {
+		std::unique_lock<std::mutex> lock(wd->mutex);
+		wd->condition.wait(lock, [wd] { return wd->signalled; });
+		wd->signalled = false;
+		break;
+	}
+	case wakeup_mechanism::semaphore:
+		wd->semaphore.wait();
+		break;
+	case wakeup_mechanism::threadpool: // The pool worker waits for its next task instead.
+		break;
+#ifndef WIN32
+	case wakeup_mechanism::eventfd: {
+		uint64_t value = 0;
+		while (read(wd->event, &value, sizeof(value)) != sizeof(value)) { // Retry on EINTR.
+		}
+		break;
+	}
+	case wakeup_mechanism::pipe: {
+		char value = 0;
+		while (read(wd->pipe[0], &value, sizeof(value)) != sizeof(value)) { // Retry on EINTR.
+		}
+		break;
+	}
+#endif
+	}
+}
+
+static void wakeup_wake(wakeup_data* wd)
+{
+	switch (wd->mechanism) {
+	case wakeup_mechanism::spin:
+		wd->word.store(1, std::memory_order_release);
+		break;
+	case wakeup_mechanism::futex:
+		wd->word.store(1, std::memory_order_release);
+#ifdef WIN32
+		WakeByAddressSingle(&wd->word);
+#else
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(&wd->word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+		break;
+	case wakeup_mechanism::condvar: {
+		{
+			std::lock_guard<std::mutex> lock(wd->mutex);
+			wd->signalled = true;
+		}
+		wd->condition.notify_one();
+		break;
+	}
+	case wakeup_mechanism::semaphore:
+		wd->semaphore.notify();
+		break;
+	case wakeup_mechanism::threadpool:
+		// The writer only gets here once the task before has armed this one.
+		wd->pool->post_task(&wd->tasks[wd->armed.load(std::memory_order_relaxed)]);
+		break;
+#ifndef WIN32
+	case wakeup_mechanism::eventfd: {
+		uint64_t value = 1;
+		while (write(wd->event, &value, sizeof(value)) != sizeof(value)) { // Retry on EINTR.
+		}
+		break;
+	}
+	case wakeup_mechanism::pipe: {
+		char value = 1;
+		while (write(wd->pipe[1], &value, sizeof(value)) != sizeof(value)) { // Retry on EINTR.
+		}
+		break;
+	}
+#endif
+	}
+}
+
+static void wakeup_read_main(wakeup_data* wd)
+{
+	sandbox::thread_affinity(0, wd->reader);
+	sandbox::thread_priority_rt();
+
+	for (uint64_t idx = 1; idx <= WAKEUP_ITERATIONS; idx++) {
+		// Announce that we are about to block, and block.
+		wd->armed.store(idx, std::memory_order_release);
+		wakeup_wait(wd);
+
+		// Record time and store.
+		uint64_t now = xmr::utility::profiler::clock::tsc::now();
+		wd->profiler->track(now, wd->time.load(std::memory_order_acquire));
+	}
+}
+
+static void wakeup_write_main(wakeup_data* wd)
+{
+	sandbox::thread_affinity(0, wd->writer);
+	sandbox::thread_priority_rt();
+
+	for (uint64_t idx = 1; idx <= WAKEUP_ITERATIONS; idx++) {
+		// Wait for the reader to be about to block.
+		while (wd->armed.load(std::memory_order_acquire) != idx) { // no-op
+		}
+
+		// Give it time to actually fall asleep.
+		auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(wd->delay_us);
+		while (std::chrono::steady_clock::now() < until) { // no-op
+		}
+
+		// Record time and wake the reader.
+		wd->time.store(xmr::utility::profiler::clock::tsc::now(), std::memory_order_release);
+		wakeup_wake(wd);
+	}
+}
+
+// Usage counters of every idle state of a processor, by name.
+static std::vector<std::pair<std::string, uint64_t>> idle_usage(uint32_t processor)
+{
+	std::vector<std::pair<std::string, uint64_t>> states;
+#ifndef WIN32
+	for (uint32_t idx = 0;; idx++) {
+		std::string   base = "/sys/devices/system/cpu/cpu" + std::to_string(processor) + "/cpuidle/state" + std::to_string(idx);
+		std::ifstream name(base + "/name");
+		std::ifstream usage(base + "/usage");
+		if (!name.good() || !usage.good()) {
+			break;
+		}
+
+		std::pair<std::string, uint64_t> state;
+		std::getline(name, state.first);
+		usage >> state.second;
+		states.push_back(state);
+	}
+#endif
+	return states;
+}
+
+// The idle state entered most often between two snapshots.
+static std::string idle_state(const std::vector<std::pair<std::string, uint64_t>>& before, const std::vector<std::pair<std::string, uint64_t>>& after)
+{
+	std::string name  = "-";
+	uint64_t    count = 0;
+	for (size_t n = 0; n < std::min(before.size(), after.size()); n++) {
+		if ((after[n].second - before[n].second) > count) {
+			count = after[n].second - before[n].second;
+			name  = after[n].first;
+		}
+	}
+	return name;
+}
+
+std::int32_t main_wakeup(std::int32_t argc, const char* argv[])
+{
+	std::vector<wakeup_mechanism> mechanisms;
+	uint32_t                      delay_us = WAKEUP_DELAY_US;
+	for (std::int32_t n = 1; n < argc; n++) {
+		auto itr = std::find_if(std::begin(wakeup_mechanisms), std::end(wakeup_mechanisms), [argv, n](auto v) { return strcmp(argv[n], wakeup_mechanism_name(v)) == 0; });
+		if (itr != std::end(wakeup_mechanisms)) {
+			mechanisms.push_back(*itr);
+		} else if ((delay_us = uint32_t(strtoul(argv[n], nullptr, 10))) == 0) {
+			printf("Usage: wakeup [spin|futex|condvar|semaphore|threadpool");
+#ifndef WIN32
+			printf("|eventfd|pipe");
+#endif
+			printf("...] [delay in microseconds]\n");
+			return 1;
+		}
+	}
+	if (mechanisms.empty()) {
+		mechanisms.assign(std::begin(wakeup_mechanisms), std::end(wakeup_mechanisms));
+	}
+
+	std::ofstream file("wakeup.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "reader,writer,mechanism,average,p50,p99,idle state" << std::endl;
+
+	// The idle driver decides which states exist at all.
+	std::string driver = "none";
+#ifndef WIN32
+	std::ifstream("/sys/devices/system/cpu/cpuidle/current_driver") >> driver;
+#endif
+
+	uint32_t max_core_id = std::thread::hardware_concurrency();
+	printf("Idle driver: %s\n", driver.c_str());
+	printf("Waking %" PRIu64 " times per pair, %" PRIu32 " us after the reader blocked...\n", uint64_t(WAKEUP_ITERATIONS), delay_us);
+	printf("Read | Write | Mechanism  | Average     | 50.00%%      | 99.00%%      | Idle state\n");
+	printf("-----+-------+------------+-------------+-------------+-------------+-----------\n");
+	for (uint32_t idx = 0; idx < max_core_id; idx++) {
+		for (uint32_t jdx = 0; jdx < max_core_id; jdx++) {
+			// Skip identical cores, a thread can not wake itself.
+			if (idx == jdx) {
+				continue;
+			}
+
+			for (auto mechanism : mechanisms) {
+				// Create and initialize structures.
+				wakeup_data wd;
+				wd.armed     = 0;
+				wd.word      = 0;
+				wd.time      = 0;
+				wd.reader    = idx;
+				wd.writer    = jdx;
+				wd.mechanism = mechanism;
+				wd.delay_us  = delay_us;
+				wd.signalled = false;
+				wd.profiler  = std::make_shared<xmr::utility::profiler::profiler>();
+#ifndef WIN32
+				wd.event = eventfd(0, 0);
+				if ((wd.event < 0) || (::pipe(wd.pipe) != 0)) {
+					printf("Failed to create eventfd or pipe.\n");
+					return 1;
+				}
+#endif
+
+				// Spawn both threads, the pool brings its own reader.
+				auto        before = idle_usage(idx);
+				std::thread a;
+				if (mechanism == wakeup_mechanism::threadpool) {
+					wd.tasks.resize(WAKEUP_ITERATIONS + 1);
+					for (size_t n = 0; n < wd.tasks.size(); n++) {
+						wd.tasks[n].wd  = &wd;
+						wd.tasks[n].idx = n;
+					}
+					wd.pool = std::make_unique<sandbox::thread_pool>(1);
+					wd.pool->post_task(&wd.tasks[0]);
+				} else {
+					a = std::thread(wakeup_read_main, &wd);
+				}
+				std::thread b(wakeup_write_main, &wd);
+
+				// Block by joining back together with the threads.
+				if (a.joinable())
+					a.join();
+				if (b.joinable())
+					b.join();
+				if (wd.pool) {
+					// The writer returns as soon as it posted the last wake-up, so wait for it to be recorded.
+					while (wd.armed.load(std::memory_order_acquire) != (WAKEUP_ITERATIONS + 1)) {
+						std::this_thread::yield();
+					}
+					wd.pool.reset(); // Joins the worker.
+				}
+				std::string idle = idle_state(before, idle_usage(idx));
+
+#ifndef WIN32
+				close(wd.event);
+				close(wd.pipe[0]);
+				close(wd.pipe[1]);
+#endif
+
+				double avg = xmr::utility::profiler::clock::tsc::to_nanoseconds(wd.profiler->average_time());
+				double p50 = xmr::utility::profiler::clock::tsc::to_nanoseconds(wd.profiler->percentile_events(0.50));
+				double p99 = xmr::utility::profiler::clock::tsc::to_nanoseconds(wd.profiler->percentile_events(0.99));
+				printf("%4" PRIu32 " | %5" PRIu32 " | %-10s | %8.1f ns | %8.1f ns | %8.1f ns | %s\n", idx, jdx, wakeup_mechanism_name(mechanism), avg, p50, p99, idle.c_str());
+				file << idx << "," << jdx << "," << wakeup_mechanism_name(mechanism) << "," << avg << "," << p50 << "," << p99 << "," << idle << std::endl;
+			}
+		}
+	}
+	file.close();
+
+	return 0;
+}
@@ -0,0 +1,171 @@
+#include <fstream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <sandbox/cpuid.hpp>
+#include <sandbox/thread.hpp>
+
+#include "simd.hpp"
+
+/* Measure the Subnormal Penalty
+
+Values that decay towards zero, like the tail of a filter or a reverb, end up as
+subnormals. Many CPUs handle those in microcode, which can cost a hundred times
+as much as the same operation on normal values.
+
+MXCSR has two bits to avoid that, at the cost of IEEE compliance:
+- FTZ (flush to zero) turns subnormal results into zero.
+- DAZ (denormals are zero) treats subnormal inputs as zero.
+
+For every vector width, type and operation, with FTZ/DAZ off and on:
+- Stream an array of normal, subnormal or mixed inputs through the operation.
+- Report the time per element for normal inputs, and how many times slower the
+  subnormal and mixed inputs are.
+
+Mixed inputs are half normal and half subnormal at random, which is what a
+vector sees while a signal decays. Vectors pay the penalty if any lane needs it.
+*/
+
+#define DENORMAL_ELEMENTS 2048 // Input and output fit into L1 even for double.
+#define MXCSR_FTZ 0x8000
+#define MXCSR_DAZ 0x0040
+
+enum class denormal_input {
+	normal,
+	subnormal,
+	mixed,
+};
+
+static const char* denormal_input_name(denormal_input input)
+{
+	switch (input) {
+	case denormal_input::normal:
+		return "normal";
+	case denormal_input::subnormal:
+		return "subnormal";
+	case denormal_input::mixed:
+		return "mixed";
+	}
+	return "unknown";
+}
+
+static const char* simd_stream_op_name(simd_stream_op op)
+{
+	switch (op) {
+	case simd_stream_op::add:
+		return "+";
+	case simd_stream_op::mul:
+		return "*";
+	case simd_stream_op::muladd:
+		return "*+";
+	case simd_stream_op::div:
+		return "/";
+	case simd_stream_op::sqrt:
+		return "sqrt";
+	}
+	return "unknown";
+}
+
+template<typename _Ty1>
+static std::vector<_Ty1> denormal_fill(denormal_input input, size_t count)
+{
+	// Subnormals are below the smallest normal value, scaled so none of them is zero or rounds up to normal.
+	std::mt19937_64                        rng(count);
+	std::uniform_real_distribution<double> normal(1.0, 2.0);
+	std::uniform_real_distribution<double> subnormal(0.01, 0.99);
+	std::bernoulli_distribution            coin(0.5);
+
+	std::vector<_Ty1> values(count);
+	for (auto& value : values) {
+		bool sub = (input == denormal_input::subnormal) || ((input == denormal_input::mixed) && coin(rng));
+		value    = sub ? _Ty1(subnormal(rng) * std::numeric_limits<_Ty1>::min()) : _Ty1(normal(rng));
+	}
+	return values;
+}
+
+struct denormal_width {
+	const char* isa;
+	size_t      bits_f32;
+	size_t      bits_f64;
+	double (*run)(const simd_stream_args& args);
+};
+
+std::int32_t main_denormal(std::int32_t argc, const char* argv[])
+{
+	sandbox::thread_affinity(0, 0);
+	sandbox::thread_priority_rt();
+
+	sandbox::timer_overhead floor = sandbox::timer_calibrate([]() { return xmr::utility::profiler::clock::tsc::now(); });
+
+	sandbox::sampling_options sampling;
+	sampling.statistic   = sandbox::sampling_statistic::median;
+	sampling.target      = 0.01;
+	sampling.min_samples = 100;
+	sampling.max_samples = 10000;
+	sampling.interval    = 100;
+
+	// Only widths this CPU can execute, the SSE translation unit also covers scalar code.
+	auto                        features = sandbox::cpuid_features();
+	std::vector<denormal_width> widths   = {{"Scalar", 32, 64, simd_stream_sse}, {"SSE", 128, 128, simd_stream_sse}};
+	if (features.avx) {
+		widths.push_back({"AVX", 256, 256, simd_stream_avx});
+	}
+	if (features.avx512f) {
+		widths.push_back({"AVX-512", 512, 512, simd_stream_avx512});
+	}
+
+	std::vector<float>  output_f32(DENORMAL_ELEMENTS);
+	std::vector<double> output_f64(DENORMAL_ELEMENTS);
+	std::vector<float>  input_f32[3];
+	std::vector<double> input_f64[3];
+	for (auto input : {denormal_input::normal, denormal_input::subnormal, denormal_input::mixed}) {
+		input_f32[size_t(input)] = denormal_fill<float>(input, DENORMAL_ELEMENTS);
+		input_f64[size_t(input)] = denormal_fill<double>(input, DENORMAL_ELEMENTS);
+	}
+
+	std::ofstream file("denormal.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "isa,type,op,ftz_daz,input,ticks,penalty" << std::endl;
+
+	printf("Streaming %" PRIu64 " elements per sample, TSC ticks per element for normal inputs, and the slowdown of the others...\n", uint64_t(DENORMAL_ELEMENTS));
+	printf("         |      |      |        FTZ/DAZ off         |        FTZ/DAZ on          \n");
+	printf("ISA      | Type | Op   |  Normal  |   Sub   |  Mixed |  Normal  |   Sub   |  Mixed \n");
+	printf("---------+------+------+----------+---------+--------+----------+---------+--------\n");
+
+	uint32_t mxcsr = _mm_getcsr();
+	for (auto& width : widths) {
+		for (bool f64 : {false, true}) {
+			for (auto op : {simd_stream_op::add, simd_stream_op::mul, simd_stream_op::muladd, simd_stream_op::div, simd_stream_op::sqrt}) {
+				printf("%-9s| %-5s| %-5s", width.isa, f64 ? "F64" : "F32", simd_stream_op_name(op));
+				for (bool ftz_daz : {false, true}) {
+					// Affects every SSE, AVX and AVX-512 instruction on this thread until it is restored.
+					_mm_setcsr(ftz_daz ? (mxcsr | MXCSR_FTZ | MXCSR_DAZ) : (mxcsr & ~uint32_t(MXCSR_FTZ | MXCSR_DAZ)));
+
+					double ticks[3];
+					for (auto input : {denormal_input::normal, denormal_input::subnormal, denormal_input::mixed}) {
+						simd_stream_args args;
+						args.op       = op;
+						args.bits     = f64 ? width.bits_f64 : width.bits_f32;
+						args.f64      = f64;
+						args.input    = f64 ? static_cast<const void*>(input_f64[size_t(input)].data()) : static_cast<const void*>(input_f32[size_t(input)].data());
+						args.output   = f64 ? static_cast<void*>(output_f64.data()) : static_cast<void*>(output_f32.data());
+						args.count    = DENORMAL_ELEMENTS;
+						args.sampling = &sampling;
+						args.floor    = floor.min;
+
+						ticks[size_t(input)] = width.run(args);
+
+						file << width.isa << "," << (f64 ? "F64" : "F32") << "," << simd_stream_op_name(op) << "," << (ftz_daz ? "on" : "off") << "," << denormal_input_name(input) << ","
+							 << ticks[size_t(input)] << "," << (ticks[size_t(input)] / ticks[size_t(denormal_input::normal)]) << std::endl;
+					}
+					printf("|%8.3f  |%7.1fx |%6.1fx ", ticks[0], ticks[1] / ticks[0], ticks[2] / ticks[0]);
+				}
+				printf("\n");
+			}
+		}
+	}
+	_mm_setcsr(mxcsr);
+	file.close();
+
+	return 0;
+}
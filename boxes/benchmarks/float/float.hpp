@@ -0,0 +1,26 @@
+#pragma once
+#include <cinttypes>
+
+/* Modes
+
+Every mode is a standalone entry point which receives the remaining arguments,
+with argv[0] being the name of the mode itself.
+*/
+
+// Run 1 to 16 independent accumulator chains per operation to find where the FP units saturate.
+std::int32_t main_throughput(std::int32_t argc, const char* argv[]);
+
+// Run the arithmetic at every vector width the CPU supports and report GFLOP/s.
+std::int32_t main_simd(std::int32_t argc, const char* argv[]);
+
+// Stream normal, subnormal and mixed inputs through each operation with FTZ/DAZ off and on.
+std::int32_t main_denormal(std::int32_t argc, const char* argv[]);
+
+// Convert large arrays between floats and fp16 or bf16 with every instruction set that supports it.
+std::int32_t main_half(std::int32_t argc, const char* argv[]);
+
+// Run a SIMD kernel on 1 to N physical cores at once and report throughput and clock per core.
+std::int32_t main_scaling(std::int32_t argc, const char* argv[]);
+
+// Sum, dot product and norm in naive and compensated forms, reporting GB/s and the error against long double.
+std::int32_t main_reduce(std::int32_t argc, const char* argv[]);
@@ -0,0 +1,196 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Profiler
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#include <sandbox/cpuid.hpp>
+#include <sandbox/sampling.hpp>
+#include <sandbox/thread.hpp>
+#include <sandbox/timer.hpp>
+
+#include "float.hpp"
+#include "half.hpp"
+
+/* Measure fp16 and bf16 Conversions
+
+Storing buffers as 16 bit values halves the memory traffic, but every value has
+to be converted on the way in and out. That only pays off if the conversion
+keeps up with memory.
+
+For every conversion the CPU supports, on arrays well past the last level cache:
+- Unpack 16 bit values to floats, and pack floats to 16 bit values.
+- Report elements per second and the bytes moved per second.
+- Report the bandwidth saved compared to reading floats at the same rate.
+- Check that packing gives the same bits as the reference for its format.
+
+A plain copy of the floats is the baseline: conversions that reach its element
+rate are limited by memory, not by the conversion.
+*/
+
+#define HALF_ELEMENTS (16ull * 1024 * 1024) // 64 MiB of floats.
+
+void bfloat_unpack_software(const uint16_t* input, float* output, size_t count)
+{
+	for (size_t n = 0; n < count; n++) {
+		uint32_t bits = uint32_t(input[n]) << 16;
+		memcpy(output + n, &bits, sizeof(bits));
+	}
+}
+
+void bfloat_pack_software(const float* input, uint16_t* output, size_t count)
+{
+	for (size_t n = 0; n < count; n++) {
+		uint32_t bits;
+		memcpy(&bits, input + n, sizeof(bits));
+		if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+			// Keep NaN a NaN, rounding could carry it into infinity.
+			output[n] = uint16_t((bits >> 16) | 0x0040);
+		} else {
+			// Round to nearest, ties to even.
+			output[n] = uint16_t((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+		}
+	}
+}
+
+static void float_copy(const float* input, float* output, size_t count)
+{
+	memcpy(output, input, count * sizeof(float));
+}
+
+struct half_kernel {
+	const char* format;
+	const char* name;
+	bool        available;
+	void (*unpack)(const uint16_t* input, float* output, size_t count); // Either may be missing, if the
+	void (*pack)(const float* input, uint16_t* output, size_t count);   // two need different features.
+};
+
+// TSC ticks for one call over the whole array.
+template<typename _Ty1>
+static double half_measure(_Ty1 run, const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	sandbox::sampler sampler(sampling);
+	while (!sampler.done()) {
+		auto t0 = xmr::utility::profiler::clock::tsc::now();
+		run();
+		auto t1 = xmr::utility::profiler::clock::tsc::now();
+		sampler.add(sandbox::timer_subtract(t1 - t0, floor));
+	}
+	return sampler.estimate();
+}
+
+std::int32_t main_half(std::int32_t argc, const char* argv[])
+{
+	size_t count = HALF_ELEMENTS;
+	if (argc > 1) {
+		count = size_t(strtoull(argv[1], nullptr, 10)) * 1024 * 1024 / sizeof(float) / 16 * 16;
+		if (count == 0) {
+			printf("Usage: %s [size of the float array in MiB]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	sandbox::thread_affinity(0, 0);
+	sandbox::thread_priority_rt();
+
+	sandbox::timer_overhead floor = sandbox::timer_calibrate([]() { return xmr::utility::profiler::clock::tsc::now(); });
+
+	// Every sample is a full pass over the arrays, so few of them are needed.
+	sandbox::sampling_options sampling;
+	sampling.statistic   = sandbox::sampling_statistic::median;
+	sampling.target      = 0.01;
+	sampling.min_samples = 5;
+	sampling.max_samples = 50;
+	sampling.interval    = 5;
+
+	auto                     features = sandbox::cpuid_features();
+	std::vector<half_kernel> kernels  = {
+		{"fp16", "F16C", features.f16c, half_unpack_f16c, half_pack_f16c},
+		{"fp16", "AVX-512F", features.avx512f, half_unpack_avx512, half_pack_avx512},
+		{"fp16", "AVX-512 FP16", features.avx512fp16, half_unpack_avx512fp16, half_pack_avx512fp16},
+		{"bf16", "Software", true, bfloat_unpack_software, bfloat_pack_software},
+		{"bf16", "AVX-512F", features.avx512f, bfloat_unpack_avx512, nullptr},
+		{"bf16", "AVX-512 BF16", features.avx512bf16, nullptr, bfloat_pack_avx512bf16},
+	};
+
+	// Finite values for both formats, fp16 tops out at 65504.
+	std::mt19937_64                       rng(count);
+	std::uniform_real_distribution<float> values(-1000.0f, 1000.0f);
+	std::vector<float>                    floats(count);
+	std::vector<float>                    floats_out(count);
+	std::vector<uint16_t>                 halves(count);
+	std::vector<uint16_t>                 halves_out(count);
+	std::vector<uint16_t>                 reference(count);
+	for (auto& value : floats) {
+		value = values(rng);
+	}
+	for (auto& value : halves) {
+		// Random bits, except for the all ones exponent of fp16 infinities and NaNs.
+		value = uint16_t(rng());
+		if ((value & 0x7C00) == 0x7C00) {
+			value &= 0xBFFF;
+		}
+	}
+
+	std::ofstream file("half.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "format,kernel,unpack_elements/s,unpack_bytes/s,pack_elements/s,pack_bytes/s,saved_bytes/s,match" << std::endl;
+
+	double ns_per_tick = xmr::utility::profiler::clock::tsc::to_nanoseconds(1000000.0) / 1000000.0;
+	double copy_ticks  = half_measure([&]() { float_copy(floats.data(), floats_out.data(), count); }, sampling, floor.min);
+	double copy_rate   = double(count) / (copy_ticks * ns_per_tick);
+
+	printf("Converting %zu elements (%zu MiB of floats)...\n", count, count * sizeof(float) / 1024 / 1024);
+	printf("Format | Kernel        |  Unpack  |  GB/s  |   Pack   |  GB/s  | Saved  | Match\n");
+	printf("       |               | Gelem/s  |        | Gelem/s  |        | GB/s   |\n");
+	printf("-------+---------------+----------+--------+----------+--------+--------+-------\n");
+	printf("%-7s| %-14s|%8.3f  |%7.2f |%8.3f  |%7.2f |%7.2f | -\n", "fp32", "Copy", copy_rate, copy_rate * 8.0, copy_rate, copy_rate * 8.0, 0.0);
+	file << "fp32,Copy," << copy_rate * 1e9 << "," << copy_rate * 8e9 << "," << copy_rate * 1e9 << "," << copy_rate * 8e9 << ",0," << std::endl;
+
+	const char* reference_format = nullptr;
+	for (auto& kernel : kernels) {
+		if (!kernel.available) {
+			printf("%-7s| %-14s| not supported\n", kernel.format, kernel.name);
+			continue;
+		}
+
+		double unpack_rate = 0, pack_rate = 0;
+		if (kernel.unpack) {
+			double ticks = half_measure([&]() { kernel.unpack(halves.data(), floats_out.data(), count); }, sampling, floor.min);
+			unpack_rate  = double(count) / (ticks * ns_per_tick);
+		}
+		if (kernel.pack) {
+			double ticks = half_measure([&]() { kernel.pack(floats.data(), halves_out.data(), count); }, sampling, floor.min);
+			pack_rate    = double(count) / (ticks * ns_per_tick);
+		}
+
+		// The first supported packing kernel of a format is the reference for the others.
+		size_t      mismatches = 0;
+		std::string match      = "ref";
+		if (!kernel.pack) {
+			match = "-";
+		} else if ((reference_format == nullptr) || (strcmp(reference_format, kernel.format) != 0)) {
+			reference_format = kernel.format;
+			reference        = halves_out;
+		} else {
+			for (size_t n = 0; n < count; n++) {
+				mismatches += (halves_out[n] != reference[n]) ? 1 : 0;
+			}
+			match = mismatches ? std::to_string(mismatches) : "yes";
+		}
+
+		// Both directions read one side and write the other, which is 2 + 4 bytes per element. Zero is a missing direction.
+		printf("%-7s| %-14s|%8.3f  |%7.2f |%8.3f  |%7.2f |%7.2f | %s\n", kernel.format, kernel.name, unpack_rate, unpack_rate * 6.0, pack_rate, pack_rate * 6.0, unpack_rate * 2.0,
+			   match.c_str());
+		file << kernel.format << "," << kernel.name << "," << unpack_rate * 1e9 << "," << unpack_rate * 6e9 << "," << pack_rate * 1e9 << "," << pack_rate * 6e9 << "," << unpack_rate * 2e9 << ","
+			 << mismatches << std::endl;
+	}
+	file.close();
+
+	return 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cinttypes>
+#include <cstddef>
+
+/* Half Precision Conversions
+
+Every kernel converts a whole array between 32 bit floats and 16 bit fp16 or
+bf16 values. Each instruction set has its own translation unit, and must only
+be called if CPUID reports support for it. Counts must be a multiple of 16.
+*/
+
+// F16C, 8 values per instruction.
+void half_unpack_f16c(const uint16_t* input, float* output, size_t count);
+void half_pack_f16c(const float* input, uint16_t* output, size_t count);
+
+// AVX-512F has the same conversions as F16C at 16 values per instruction.
+void half_unpack_avx512(const uint16_t* input, float* output, size_t count);
+void half_pack_avx512(const float* input, uint16_t* output, size_t count);
+
+// AVX-512 FP16, which adds native fp16 arithmetic and its own conversions.
+void half_unpack_avx512fp16(const uint16_t* input, float* output, size_t count);
+void half_pack_avx512fp16(const float* input, uint16_t* output, size_t count);
+
+// bf16 is the upper half of a float, so unpacking is a shift and only packing needs rounding.
+void bfloat_unpack_software(const uint16_t* input, float* output, size_t count);
+void bfloat_pack_software(const float* input, uint16_t* output, size_t count);
+void bfloat_unpack_avx512(const uint16_t* input, float* output, size_t count);
+void bfloat_pack_avx512bf16(const float* input, uint16_t* output, size_t count);
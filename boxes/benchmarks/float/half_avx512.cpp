@@ -0,0 +1,30 @@
+#include <immintrin.h>
+
+#include "half.hpp"
+
+// GCC 12 trips over the deliberately undefined pass-through operand of the unmasked AVX-512 intrinsics.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+void half_unpack_avx512(const uint16_t* input, float* output, size_t count)
+{
+	for (size_t n = 0; n < count; n += 16) {
+		_mm512_storeu_ps(output + n, _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + n))));
+	}
+}
+
+void half_pack_avx512(const float* input, uint16_t* output, size_t count)
+{
+	for (size_t n = 0; n < count; n += 16) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + n), _mm512_cvtps_ph(_mm512_loadu_ps(input + n), _MM_FROUND_TO_NEAREST_INT));
+	}
+}
+
+void bfloat_unpack_avx512(const uint16_t* input, float* output, size_t count)
+{
+	for (size_t n = 0; n < count; n += 16) {
+		__m512i wide = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + n)));
+		_mm512_storeu_si512(output + n, _mm512_slli_epi32(wide, 16));
+	}
+}
@@ -0,0 +1,13 @@
+#include <cstring>
+#include <immintrin.h>
+
+#include "half.hpp"
+
+void bfloat_pack_avx512bf16(const float* input, uint16_t* output, size_t count)
+{
+	for (size_t n = 0; n < count; n += 16) {
+		// The bf16 vector type differs between compilers, the copy turns into a plain store.
+		__m256bh packed = _mm512_cvtneps_pbh(_mm512_loadu_ps(input + n));
+		memcpy(output + n, &packed, sizeof(packed));
+	}
+}
@@ -0,0 +1,17 @@
+#include <immintrin.h>
+
+#include "half.hpp"
+
+void half_unpack_avx512fp16(const uint16_t* input, float* output, size_t count)
+{
+	for (size_t n = 0; n < count; n += 16) {
+		_mm512_storeu_ps(output + n, _mm512_cvtxph_ps(_mm256_loadu_ph(input + n)));
+	}
+}
+
+void half_pack_avx512fp16(const float* input, uint16_t* output, size_t count)
+{
+	for (size_t n = 0; n < count; n += 16) {
+		_mm256_storeu_ph(output + n, _mm512_cvtxps_ph(_mm512_loadu_ps(input + n)));
+	}
+}
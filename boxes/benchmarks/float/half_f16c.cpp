@@ -0,0 +1,17 @@
+#include <immintrin.h>
+
+#include "half.hpp"
+
+void half_unpack_f16c(const uint16_t* input, float* output, size_t count)
+{
+	for (size_t n = 0; n < count; n += 8) {
+		_mm256_storeu_ps(output + n, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + n))));
+	}
+}
+
+void half_pack_f16c(const float* input, uint16_t* output, size_t count)
+{
+	for (size_t n = 0; n < count; n += 8) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output + n), _mm256_cvtps_ph(_mm256_loadu_ps(input + n), _MM_FROUND_TO_NEAREST_INT));
+	}
+}
@@ -1,8 +1,12 @@
 #include <chrono>
 #include <cinttypes>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #ifdef WIN32
 #define NOMINMAX
@@ -15,53 +19,16 @@
 #include <xmr/utility/profiler/clock/tsc.hpp>
 #include <xmr/utility/profiler/profiler.hpp>
 
+#include <sandbox/optimize.hpp>
+#include <sandbox/sampling.hpp>
+#include <sandbox/timer.hpp>
+
+#include "float.hpp"
+#include "operations.hpp"
+
 #define ITERATIONS 1000
 #define INNER_ITERATIONS 10000
-
-#define REPEAT_10(A) \
-	A;               \
-	A;               \
-	A;               \
-	A;               \
-	A;               \
-	A;               \
-	A;               \
-	A;               \
-	A;               \
-	A;
-#define REPEAT_100(A) \
-	REPEAT_10(A);     \
-	REPEAT_10(A);     \
-	REPEAT_10(A);     \
-	REPEAT_10(A);     \
-	REPEAT_10(A);     \
-	REPEAT_10(A);     \
-	REPEAT_10(A);     \
-	REPEAT_10(A);     \
-	REPEAT_10(A);     \
-	REPEAT_10(A);
-#define REPEAT_1000(A) \
-	REPEAT_100(A);     \
-	REPEAT_100(A);     \
-	REPEAT_100(A);     \
-	REPEAT_100(A);     \
-	REPEAT_100(A);     \
-	REPEAT_100(A);     \
-	REPEAT_100(A);     \
-	REPEAT_100(A);     \
-	REPEAT_100(A);     \
-	REPEAT_100(A);
-#define REPEAT_10000(A) \
-	REPEAT_1000(A);     \
-	REPEAT_1000(A);     \
-	REPEAT_1000(A);     \
-	REPEAT_1000(A);     \
-	REPEAT_1000(A);     \
-	REPEAT_1000(A);     \
-	REPEAT_1000(A);     \
-	REPEAT_1000(A);     \
-	REPEAT_1000(A);     \
-	REPEAT_1000(A);
+#define UNROLL 100
 
 template<typename _Ty1>
 bool is_equal(const _Ty1 a, const _Ty1 b, const _Ty1 edge = 0.000001)
@@ -83,48 +50,75 @@ bool is_equal(const _Ty1 a, const _Ty1 b, const _Ty1 edge = 0.000001)
 	return false;
 }
 
-template<typename _Ty1>
-std::shared_ptr<xmr::utility::profiler::profiler> benchmark_addsub()
+// One chain step per index, so the loop body holds as many steps as the sequence is long.
+template<typename _Op, typename _Ty1, size_t... _Index>
+inline void benchmark_step(_Ty1& v, std::index_sequence<_Index...>)
+{
+	// Overhead: none, the value never leaves its register.
+	((void(_Index), v = _Op::template apply<_Ty1>(v), sandbox::do_not_optimize(v)), ...);
+}
+
+// The same through a volatile, which is how these benchmarks used to work. Kept for comparison.
+template<typename _Op, typename _Ty1, size_t... _Index>
+inline void benchmark_step(volatile _Ty1& v, std::index_sequence<_Index...>)
+{
+	// Overhead:
+	// - MSVC: 2x movss
+	((void(_Index), v = _Op::template apply<_Ty1>(v)), ...);
+}
+
+template<typename _Ty1, typename _Op, size_t _Unroll, bool _Volatile>
+std::shared_ptr<xmr::utility::profiler::profiler> benchmark(sandbox::sampler& sampler, uint64_t floor)
 {
+	static_assert((INNER_ITERATIONS % _Unroll) == 0, "The unroll factor must divide the number of operations.");
+
 	std::shared_ptr<xmr::utility::profiler::profiler> profile = std::make_shared<xmr::utility::profiler::profiler>();
 
-	for (volatile size_t n = 0; n < ITERATIONS; n++) {
-		const _Ty1    a = 1.0;
-		const _Ty1    b = 2.0;
-		const _Ty1    c = a + b * INNER_ITERATIONS - a * INNER_ITERATIONS;
-		volatile _Ty1 v = 0;
+	while (!sampler.done()) {
+		std::conditional_t<_Volatile, volatile _Ty1, _Ty1> v = _Ty1(OPERATION_START);
 
-		// Overhead:
-		// - MSVC: 2x movss
 		auto t0 = xmr::utility::profiler::clock::tsc::now();
-		REPEAT_10000(v = (v + b) - a;);
+		for (size_t n = 0; n < (INNER_ITERATIONS / _Unroll); n++) {
+			benchmark_step<_Op>(v, std::make_index_sequence<_Unroll>());
+		}
 		auto t1 = xmr::utility::profiler::clock::tsc::now();
-		profile->track(t1, t0);
+		uint64_t elapsed = sandbox::timer_subtract(t1 - t0, floor);
+		profile->track(t0 + elapsed, t0);
+		sampler.add(elapsed);
 	}
 
 	return profile;
 }
 
-template<typename _Ty1>
-std::shared_ptr<xmr::utility::profiler::profiler> benchmark_muladd()
+template<typename _Ty1, typename _Op>
+void report(const sandbox::sampling_options& sampling, uint64_t floor)
 {
-	std::shared_ptr<xmr::utility::profiler::profiler> profile = std::make_shared<xmr::utility::profiler::profiler>();
-
-	for (volatile size_t n = 0; n < ITERATIONS; n++) {
-		const _Ty1    a = 1.0;
-		const _Ty1    b = 2.0;
-		const _Ty1    c = a + b * INNER_ITERATIONS - a * INNER_ITERATIONS;
-		volatile _Ty1 v = a;
-
-		// Overhead:
-		// - MSVC: 2x movss
-		auto t0 = xmr::utility::profiler::clock::tsc::now();
-		REPEAT_10000(v = a + (v * b););
-		auto t1 = xmr::utility::profiler::clock::tsc::now();
-		profile->track(t1, t0);
+	if constexpr (operation_available<_Op>::value) {
+		std::string name = std::string(std::is_same<_Ty1, float>::value ? "F32 " : "F64 ") + _Op::name;
+
+		sandbox::sampler s(sampling);
+		auto             p = benchmark<_Ty1, _Op, UNROLL, false>(s, floor);
+
+		// Only the average of the volatile chain, the difference to the one above is the cost of going through memory.
+		sandbox::sampler vs(sampling);
+		auto             vp = benchmark<_Ty1, _Op, UNROLL, true>(vs, floor);
+
+		printf("%-13s|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fms|%8.3f%%|%9" PRIu64 "\n", name.c_str(),
+			   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9999)) / INNER_ITERATIONS,
+			   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9990)) / INNER_ITERATIONS,
+			   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9900)) / INNER_ITERATIONS,
+			   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9500)) / INNER_ITERATIONS,
+			   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->average_time()) / INNER_ITERATIONS,
+			   xmr::utility::profiler::clock::tsc::to_nanoseconds(vp->average_time()) / INNER_ITERATIONS,
+			   xmr::utility::profiler::clock::tsc::to_milliseconds(p->total_time()), s.precision() * 100.0, s.count());
 	}
+}
 
-	return profile;
+// Every operation of the registry, first in single and then in double precision.
+template<typename... _Ops>
+void report_all(const std::tuple<_Ops...>*, const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	((report<float, _Ops>(sampling, floor), report<double, _Ops>(sampling, floor)), ...);
 }
 
 std::int32_t main(std::int32_t argc, const char* argv[])
@@ -138,58 +132,51 @@ std::int32_t main(std::int32_t argc, const char* argv[])
 	SetPriorityClass(GetCurrentProcess(), REALTIME_PRIORITY_CLASS);
 #endif
 
-	{
-		printf("Testing with %" PRIu64 "*%" PRIu64 " iterations...\n", uint64_t(ITERATIONS),
-			   uint64_t(INNER_ITERATIONS));
-		printf("Test      |  99.99%%  |  99.90%%  |  99.00%%  |  95.00%%  | Average  | Total    \n");
-		printf("----------+----------+----------+----------+----------+----------+----------\n");
+	// Select the mode to run, defaulting to the latency tests of a single chain.
+	if (argc > 1) {
+		if (strcmp(argv[1], "throughput") == 0) {
+			return main_throughput(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "simd") == 0) {
+			return main_simd(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "denormal") == 0) {
+			return main_denormal(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "half") == 0) {
+			return main_half(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "scaling") == 0) {
+			return main_scaling(argc - 1, argv + 1);
+		} else if (strcmp(argv[1], "reduce") == 0) {
+			return main_reduce(argc - 1, argv + 1);
+		}
+		printf("Usage: %s [throughput|simd|denormal|half|scaling|reduce]\n", argv[0]);
+		return 1;
 	}
 
-	{     // Add-Sub
-		{ // FP32
-			auto  p = benchmark_addsub<float>();
-			printf("%-10s|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fms\n", "F32 +-",
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9999)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9990)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9900)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9500)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->average_time()) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_milliseconds(p->total_time()));
-		}
-		{ // FP64
-			auto   p = benchmark_addsub<double>();
-			printf("%-10s|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fms\n", "F64 +-",
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9999)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9990)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9900)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9500)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->average_time()) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_milliseconds(p->total_time()));
-		}
+	// Measure until the mean is known to within 0.5%, with at least 100 and at most 100x the old iteration count.
+	sandbox::sampling_options sampling;
+	sampling.statistic   = sandbox::sampling_statistic::mean;
+	sampling.target      = 0.005;
+	sampling.min_samples = ITERATIONS / 10;
+	sampling.max_samples = ITERATIONS * 100;
+	sampling.interval    = ITERATIONS / 10;
+
+	// Every sample also contains one tsc::now(), which is measured here and removed from the results.
+	{
+		printf("Calibrating timers...\n");
+		sandbox::timer_print(xmr::utility::profiler::clock::tsc::to_nanoseconds(1000000.0) / 1000000.0);
 	}
-	{     // FMA
-		{ // FP32
-			auto p = benchmark_muladd<float>();
-			printf("%-10s|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fms\n", "F32 FMA",
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9999)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9990)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9900)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9500)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->average_time()) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_milliseconds(p->total_time()));
-		}
-		{ // FP64
-			auto p = benchmark_muladd<double>();
-			printf("%-10s|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fns|%8.2fms\n", "F64 FMA",
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9999)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9990)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9900)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->percentile_events(0.9500)) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_nanoseconds(p->average_time()) / INNER_ITERATIONS,
-				   xmr::utility::profiler::clock::tsc::to_milliseconds(p->total_time()));
-		}
+	sandbox::timer_overhead floor = sandbox::timer_calibrate([]() { return xmr::utility::profiler::clock::tsc::now(); });
+	printf("Subtracting the tsc::now() floor of %.2fns per sample (%.4fns per operation).\n\n", xmr::utility::profiler::clock::tsc::to_nanoseconds(double(floor.min)),
+		   xmr::utility::profiler::clock::tsc::to_nanoseconds(double(floor.min)) / INNER_ITERATIONS);
+
+	{
+		printf("Testing with up to %" PRIu64 "*%" PRIu64 " iterations, until the %.0f%% confidence interval of the mean is within %.2f%%...\n",
+			   uint64_t(sampling.max_samples), uint64_t(INNER_ITERATIONS), sampling.confidence * 100.0, sampling.target * 100.0);
+		printf("Test         |  99.99%%  |  99.90%%  |  99.00%%  |  95.00%%  | Average  | Volatile | Total    | CI Width | Samples \n");
+		printf("-------------+----------+----------+----------+----------+----------+----------+----------+----------+---------\n");
 	}
 
+	report_all(static_cast<const float_operations*>(nullptr), sampling, floor.min);
+
 	std::cin.get();
 	return 0;
 }
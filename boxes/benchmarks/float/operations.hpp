@@ -0,0 +1,150 @@
+#pragma once
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <tuple>
+
+/* Operations
+
+Every operation is one step of a dependency chain: it takes the previous value
+and returns the next one, so a step can not start before the one before it is
+done. The constants keep the chain in the normal range for as many steps as one
+sample runs, as denormals and infinities take different paths in the FP units.
+
+Adding an operation is a struct here and an entry in float_operations, the
+benchmark loops and the reporting are generated from that list.
+*/
+
+#define OPERATION_START 1.5
+
+struct op_add {
+	static constexpr const char* name = "+";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return v + _Ty1(1.0);
+	}
+};
+
+struct op_sub {
+	static constexpr const char* name = "-";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return v - _Ty1(1.0);
+	}
+};
+
+struct op_addsub {
+	static constexpr const char* name = "+-";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return (v + _Ty1(2.0)) - _Ty1(1.0);
+	}
+};
+
+struct op_mul {
+	static constexpr const char* name = "*";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return v * _Ty1(0.999);
+	}
+};
+
+struct op_div {
+	static constexpr const char* name = "/";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return v / _Ty1(1.001);
+	}
+};
+
+// A separate multiply and add, unless the compiler decides to contract them.
+struct op_muladd {
+	static constexpr const char* name = "*+";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return _Ty1(0.5) + (v * _Ty1(0.5));
+	}
+};
+
+// A fused multiply-add, which std::fma only compiles to if the target has FMA.
+struct op_fma {
+	static constexpr const char* name = "fma";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return std::fma(v, _Ty1(0.5), _Ty1(0.5));
+	}
+};
+
+struct op_sqrt {
+	static constexpr const char* name = "sqrt";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return std::sqrt(v);
+	}
+};
+
+// The exact reciprocal square root, a square root followed by a division.
+struct op_rsqrt {
+	static constexpr const char* name = "1/sqrt";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return _Ty1(1.0) / std::sqrt(v);
+	}
+};
+
+struct op_minmax {
+	static constexpr const char* name = "min/max";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return std::min(std::max(v, _Ty1(1.0)), _Ty1(2.0));
+	}
+};
+
+// Truncate to an integer and convert back.
+struct op_convert {
+	static constexpr const char* name = "int<->fp";
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v)
+	{
+		return _Ty1(int32_t(v));
+	}
+};
+
+// Operations which only make sense on some targets.
+template<typename _Op>
+struct operation_available {
+	static constexpr bool value = true;
+};
+
+template<>
+struct operation_available<op_fma> {
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+	static constexpr bool value = true;
+#else
+	// Without FMA in the target, std::fma is a library call that emulates it in software.
+	static constexpr bool value = false;
+#endif
+};
+
+using float_operations = std::tuple<op_add, op_sub, op_addsub, op_mul, op_div, op_muladd, op_fma, op_sqrt, op_rsqrt, op_minmax, op_convert>;
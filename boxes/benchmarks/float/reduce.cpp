@@ -0,0 +1,198 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <sandbox/cpuid.hpp>
+#include <sandbox/thread.hpp>
+
+#include "reduce.hpp"
+
+/* Measure Reductions
+
+A sum over a few million values loses digits in every addition, and how many
+depends on the form of the loop more than on the precision of the type. The
+careful forms cost extra operations, which may or may not be hidden behind the
+memory bandwidth.
+
+For every operation, form and vector width, over arrays from L1 to memory:
+- Report GB/s of input read.
+- Report the relative error against a sequential sum in long double.
+
+The inputs are uniform in [0, 1), so there is no cancellation and every error is
+the rounding of the sum itself. Where long double is the same as double, as with
+MSVC, the reference for F64 is no better than the naive sum, and the F64 errors
+are only meaningful relative to each other.
+*/
+
+static constexpr size_t reduce_sizes[] = {
+	4 * 1024,         // L1
+	64 * 1024,        // L2
+	1024 * 1024,      // L3
+	16 * 1024 * 1024, // Memory
+};
+
+reduce_result reduce_sse(const reduce_args& args)
+{
+	if (args.bits == 128) {
+		return args.f64 ? reduce<__m128d>(args) : reduce<__m128>(args);
+	}
+	return args.f64 ? reduce<double>(args) : reduce<float>(args);
+}
+
+static const char* reduce_op_name(reduce_op op)
+{
+	switch (op) {
+	case reduce_op::sum:
+		return "sum";
+	case reduce_op::dot:
+		return "dot";
+	case reduce_op::norm:
+		return "norm";
+	}
+	return "unknown";
+}
+
+static const char* reduce_form_name(reduce_form form)
+{
+	switch (form) {
+	case reduce_form::naive:
+		return "naive";
+	case reduce_form::multi:
+		return "multi";
+	case reduce_form::pairwise:
+		return "pairwise";
+	case reduce_form::kahan:
+		return "kahan";
+	case reduce_form::neumaier:
+		return "neumaier";
+	}
+	return "unknown";
+}
+
+template<typename _Element>
+static long double reduce_reference(reduce_op op, const std::vector<_Element>& x, const std::vector<_Element>& y, size_t count)
+{
+	long double sum = 0;
+	for (size_t n = 0; n < count; n++) {
+		long double term = (op == reduce_op::dot) ? (static_cast<long double>(x[n]) * static_cast<long double>(y[n])) : static_cast<long double>(x[n]);
+		sum += (op == reduce_op::norm) ? (term * term) : term;
+	}
+	return (op == reduce_op::norm) ? std::sqrt(sum) : sum;
+}
+
+struct reduce_width {
+	const char* isa;
+	size_t      bits_f32;
+	size_t      bits_f64;
+	reduce_result (*run)(const reduce_args& args);
+};
+
+template<typename _Element>
+static void reduce_report(const std::vector<reduce_width>& widths, const sandbox::sampling_options& sampling, uint64_t floor, double ns_per_tick, std::ofstream& file)
+{
+	constexpr bool f64      = sizeof(_Element) == sizeof(double);
+	constexpr auto max_size = reduce_sizes[std::size(reduce_sizes) - 1];
+
+	std::mt19937_64                          rng(max_size);
+	std::uniform_real_distribution<_Element> values(_Element(0.0), _Element(1.0));
+	std::vector<_Element>                    x(max_size);
+	std::vector<_Element>                    y(max_size);
+	for (size_t n = 0; n < max_size; n++) {
+		x[n] = values(rng);
+		y[n] = values(rng);
+	}
+
+	for (auto op : {reduce_op::sum, reduce_op::dot, reduce_op::norm}) {
+		long double reference[std::size(reduce_sizes)];
+		for (size_t s = 0; s < std::size(reduce_sizes); s++) {
+			reference[s] = reduce_reference(op, x, y, reduce_sizes[s]);
+		}
+
+		for (auto form : {reduce_form::naive, reduce_form::multi, reduce_form::pairwise, reduce_form::kahan, reduce_form::neumaier}) {
+			for (auto& width : widths) {
+				printf("%-5s| %-5s| %-9s| %-8s", f64 ? "F64" : "F32", reduce_op_name(op), reduce_form_name(form), width.isa);
+
+				double error = 0;
+				for (size_t s = 0; s < std::size(reduce_sizes); s++) {
+					reduce_args args;
+					args.op       = op;
+					args.form     = form;
+					args.bits     = f64 ? width.bits_f64 : width.bits_f32;
+					args.f64      = f64;
+					args.x        = x.data();
+					args.y        = y.data();
+					args.count    = reduce_sizes[s];
+					args.sampling = &sampling;
+					args.floor    = floor;
+
+					reduce_result r     = width.run(args);
+					size_t        bytes = reduce_sizes[s] * sizeof(_Element) * ((op == reduce_op::dot) ? 2 : 1);
+					double        gbps  = double(bytes) / (r.ticks * ns_per_tick);
+					error               = double(std::fabs((static_cast<long double>(r.value) - reference[s]) / reference[s]));
+
+					printf("|%8.2f ", gbps);
+					file << (f64 ? "F64" : "F32") << "," << reduce_op_name(op) << "," << reduce_form_name(form) << "," << width.isa << "," << reduce_sizes[s] << "," << gbps * 1e9 << ","
+						 << r.value << "," << double(reference[s]) << "," << error << std::endl;
+				}
+
+				// The error of the largest array, where the forms differ the most.
+				printf("|%10.2e\n", error);
+			}
+		}
+	}
+}
+
+std::int32_t main_reduce(std::int32_t argc, const char* argv[])
+{
+	bool run_f32 = true, run_f64 = true;
+	if (argc > 1) {
+		run_f32 = strcmp(argv[1], "f32") == 0;
+		run_f64 = strcmp(argv[1], "f64") == 0;
+		if (!run_f32 && !run_f64) {
+			printf("Usage: %s [f32|f64]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	sandbox::thread_affinity(0, 0);
+	sandbox::thread_priority_rt();
+
+	sandbox::timer_overhead floor = sandbox::timer_calibrate([]() { return xmr::utility::profiler::clock::tsc::now(); });
+
+	// Every sample is a full pass over the array, so few of them are needed.
+	sandbox::sampling_options sampling;
+	sampling.statistic   = sandbox::sampling_statistic::median;
+	sampling.target      = 0.01;
+	sampling.min_samples = 5;
+	sampling.max_samples = 50;
+	sampling.interval    = 5;
+
+	// Only widths this CPU can execute, the SSE translation unit also covers scalar code.
+	auto                      features = sandbox::cpuid_features();
+	std::vector<reduce_width> widths   = {{"Scalar", 32, 64, reduce_sse}, {"SSE", 128, 128, reduce_sse}};
+	if (features.avx) {
+		widths.push_back({"AVX", 256, 256, reduce_avx});
+	}
+	if (features.avx512f) {
+		widths.push_back({"AVX-512", 512, 512, reduce_avx512});
+	}
+
+	std::ofstream file("reduce.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "type,op,form,isa,elements,bytes/s,value,reference,relative_error" << std::endl;
+
+	double ns_per_tick = xmr::utility::profiler::clock::tsc::to_nanoseconds(1000000.0) / 1000000.0;
+	printf("GB/s of input per array size in elements, relative error against long double for the largest array...\n");
+	printf("Type | Op   | Form     | ISA     |   4Ki    |   64Ki   |   1Mi    |   16Mi   | Rel. error\n");
+	printf("-----+------+----------+---------+----------+----------+----------+----------+-----------\n");
+	if (run_f32) {
+		reduce_report<float>(widths, sampling, floor.min, ns_per_tick, file);
+	}
+	if (run_f64) {
+		reduce_report<double>(widths, sampling, floor.min, ns_per_tick, file);
+	}
+	file.close();
+
+	return 0;
+}
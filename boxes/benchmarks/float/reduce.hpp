@@ -0,0 +1,325 @@
+#pragma once
+#include <cinttypes>
+#include <utility>
+
+#include "simd.hpp"
+
+/* Reduction Kernels
+
+Sums, dot products and norms in the forms that trade speed for accuracy:
+- naive:    One accumulator. The error grows with the length of the array.
+- multi:    Independent accumulators, combined at the end. Faster, and a little
+            more accurate as every accumulator sees a shorter sum.
+- pairwise: Recursive halving down to blocks summed with multi. The error grows
+            with the logarithm of the length.
+- kahan:    One accumulator with a running compensation for the lost low bits.
+- neumaier: Like Kahan, but also correct when a term is larger than the sum.
+
+Every form works on any of the simd_traits types, so the same code is scalar or
+SIMD depending on the type, with every lane an independent sum until the end.
+Compensated forms only correct the summation, the rounding of the products of a
+dot product or norm remains.
+
+This header is compiled into the translation unit of every instruction set, like
+simd.hpp, which it builds on.
+*/
+
+#define REDUCE_ACCUMULATORS 8
+#define REDUCE_PAIRWISE_BLOCK 256 // Elements, a multiple of the widest register times the accumulators.
+
+enum class reduce_op {
+	sum,  // x[i]
+	dot,  // x[i] * y[i]
+	norm, // sqrt(x[i] * x[i])
+};
+
+enum class reduce_form {
+	naive,
+	multi,
+	pairwise,
+	kahan,
+	neumaier,
+};
+
+struct reduce_args {
+	reduce_op                        op;
+	reduce_form                      form;
+	size_t                           bits; // Register width, or the element size for scalar code.
+	bool                             f64;
+	const void*                      x;
+	const void*                      y;     // Only read by dot.
+	size_t                           count; // Elements, a multiple of REDUCE_PAIRWISE_BLOCK.
+	const sandbox::sampling_options* sampling;
+	uint64_t                         floor;
+};
+
+struct reduce_result {
+	double ticks; // TSC ticks for one pass over the array.
+	double value;
+};
+
+namespace {
+	// Instead of std::sqrt, which is an inline function with external linkage and would be emitted by every translation
+	// unit with its own instruction set, see simd.hpp.
+	inline float reduce_sqrt(float v)
+	{
+		return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(v)));
+	}
+
+	inline double reduce_sqrt(double v)
+	{
+		return _mm_cvtsd_f64(_mm_sqrt_sd(_mm_setzero_pd(), _mm_set_sd(v)));
+	}
+
+	struct reduce_term_sum {
+		template<typename _Ty1, typename _Element>
+		static _Ty1 term(const _Element* x, const _Element*, size_t n)
+		{
+			return simd_traits<_Ty1>::load(x + n);
+		}
+
+		template<typename _Element>
+		static _Element finish(_Element v)
+		{
+			return v;
+		}
+	};
+
+	struct reduce_term_dot {
+		template<typename _Ty1, typename _Element>
+		static _Ty1 term(const _Element* x, const _Element* y, size_t n)
+		{
+			return simd_traits<_Ty1>::mul(simd_traits<_Ty1>::load(x + n), simd_traits<_Ty1>::load(y + n));
+		}
+
+		template<typename _Element>
+		static _Element finish(_Element v)
+		{
+			return v;
+		}
+	};
+
+	struct reduce_term_norm {
+		template<typename _Ty1, typename _Element>
+		static _Ty1 term(const _Element* x, const _Element*, size_t n)
+		{
+			_Ty1 v = simd_traits<_Ty1>::load(x + n);
+			return simd_traits<_Ty1>::mul(v, v);
+		}
+
+		template<typename _Element>
+		static _Element finish(_Element v)
+		{
+			return reduce_sqrt(v);
+		}
+	};
+
+	// Every lane of the sum, and what has to be added to it to correct it.
+	template<typename _Ty1>
+	struct reduce_partial {
+		_Ty1 sum;
+		_Ty1 compensation;
+	};
+
+	template<typename _Ty1, typename _Term, typename _Element>
+	inline reduce_partial<_Ty1> reduce_naive(const _Element* x, const _Element* y, size_t begin, size_t end)
+	{
+		using traits = simd_traits<_Ty1>;
+
+		_Ty1 s = traits::set1(0.0);
+		for (size_t n = begin; n < end; n += traits::lanes) {
+			s = traits::add(s, _Term::template term<_Ty1>(x, y, n));
+		}
+		return {s, traits::set1(0.0)};
+	}
+
+	// Keeps the accumulators apart, so scalar code is not turned into vectors behind our back.
+	template<typename _Ty1, typename _Term, typename _Element, size_t... _Index>
+	inline void reduce_multi_step(_Ty1 (&acc)[sizeof...(_Index)], const _Element* x, const _Element* y, size_t n, std::index_sequence<_Index...>)
+	{
+		((acc[_Index] = simd_traits<_Ty1>::add(acc[_Index], _Term::template term<_Ty1>(x, y, n + _Index * simd_traits<_Ty1>::lanes)), sandbox::do_not_optimize(acc[_Index])), ...);
+	}
+
+	// Combines the accumulators as a tree, which is itself a small pairwise sum. Constant indices again.
+	template<size_t _Width, typename _Ty1, size_t... _Index>
+	inline void reduce_combine_step(_Ty1 (&acc)[REDUCE_ACCUMULATORS], std::index_sequence<_Index...>)
+	{
+		((acc[_Index] = simd_traits<_Ty1>::add(acc[_Index], acc[_Index + _Width])), ...);
+	}
+
+	template<size_t _Width, typename _Ty1>
+	inline void reduce_combine(_Ty1 (&acc)[REDUCE_ACCUMULATORS])
+	{
+		if constexpr (_Width > 0) {
+			reduce_combine_step<_Width>(acc, std::make_index_sequence<_Width>());
+			reduce_combine<_Width / 2>(acc);
+		}
+	}
+
+	template<typename _Ty1, typename _Term, typename _Element>
+	inline reduce_partial<_Ty1> reduce_multi(const _Element* x, const _Element* y, size_t begin, size_t end)
+	{
+		using traits = simd_traits<_Ty1>;
+
+		_Ty1 acc[REDUCE_ACCUMULATORS];
+		simd_fill(acc, traits::set1(0.0), std::make_index_sequence<REDUCE_ACCUMULATORS>());
+		for (size_t n = begin; n < end; n += traits::lanes * REDUCE_ACCUMULATORS) {
+			reduce_multi_step<_Ty1, _Term>(acc, x, y, n, std::make_index_sequence<REDUCE_ACCUMULATORS>());
+		}
+
+		reduce_combine<REDUCE_ACCUMULATORS / 2>(acc);
+		return {acc[0], traits::set1(0.0)};
+	}
+
+	template<typename _Ty1, typename _Term, typename _Element>
+	inline _Ty1 reduce_pairwise_sum(const _Element* x, const _Element* y, size_t begin, size_t end)
+	{
+		size_t count = end - begin;
+		if (count <= REDUCE_PAIRWISE_BLOCK) {
+			return reduce_multi<_Ty1, _Term>(x, y, begin, end).sum;
+		}
+
+		// Split on a block boundary, so every leaf is a whole block.
+		size_t middle = begin + (count / 2 / REDUCE_PAIRWISE_BLOCK) * REDUCE_PAIRWISE_BLOCK;
+		return simd_traits<_Ty1>::add(reduce_pairwise_sum<_Ty1, _Term>(x, y, begin, middle), reduce_pairwise_sum<_Ty1, _Term>(x, y, middle, end));
+	}
+
+	template<typename _Ty1, typename _Term, typename _Element>
+	inline reduce_partial<_Ty1> reduce_pairwise(const _Element* x, const _Element* y, size_t begin, size_t end)
+	{
+		return {reduce_pairwise_sum<_Ty1, _Term>(x, y, begin, end), simd_traits<_Ty1>::set1(0.0)};
+	}
+
+	template<typename _Ty1, typename _Term, typename _Element>
+	inline reduce_partial<_Ty1> reduce_kahan(const _Element* x, const _Element* y, size_t begin, size_t end)
+	{
+		using traits = simd_traits<_Ty1>;
+
+		// c is the error of the previous step, taken back out of the next term.
+		_Ty1 s = traits::set1(0.0);
+		_Ty1 c = traits::set1(0.0);
+		for (size_t n = begin; n < end; n += traits::lanes) {
+			_Ty1 v = traits::sub(_Term::template term<_Ty1>(x, y, n), c);
+			_Ty1 t = traits::add(s, v);
+			c      = traits::sub(traits::sub(t, s), v);
+			s      = t;
+		}
+		return {s, traits::sub(traits::set1(0.0), c)};
+	}
+
+	template<typename _Ty1, typename _Term, typename _Element>
+	inline reduce_partial<_Ty1> reduce_neumaier(const _Element* x, const _Element* y, size_t begin, size_t end)
+	{
+		using traits = simd_traits<_Ty1>;
+
+		// Neumaier picks the larger of sum and term with a branch to get the exact error of the addition. Knuth's
+		// two-sum gets the same error without the branch, which lets every lane take its own path.
+		_Ty1 s = traits::set1(0.0);
+		_Ty1 c = traits::set1(0.0);
+		for (size_t n = begin; n < end; n += traits::lanes) {
+			_Ty1 v = _Term::template term<_Ty1>(x, y, n);
+			_Ty1 t = traits::add(s, v);
+			_Ty1 b = traits::sub(t, s);
+			c      = traits::add(c, traits::add(traits::sub(s, traits::sub(t, b)), traits::sub(v, b)));
+			s      = t;
+		}
+		return {s, c};
+	}
+
+	// Adds up the lanes, with the same care as the form that produced them.
+	template<typename _Ty1, typename _Term>
+	inline double reduce_finish(const reduce_partial<_Ty1>& partial, bool compensated)
+	{
+		using traits  = simd_traits<_Ty1>;
+		using element = typename traits::element;
+
+		element sum[traits::lanes], compensation[traits::lanes];
+		traits::store(sum, partial.sum);
+		traits::store(compensation, partial.compensation);
+
+		element total = sum[0], error = compensation[0];
+		for (size_t n = 1; n < traits::lanes; n++) {
+			if (compensated) {
+				element t = total + sum[n];
+				element b = t - total;
+				error += (total - (t - b)) + (sum[n] - b);
+				error += compensation[n];
+				total = t;
+			} else {
+				total += sum[n];
+			}
+		}
+		return double(_Term::finish(element(total + error)));
+	}
+
+	// Keeps the result of every pass alive.
+	static volatile double reduce_sink;
+
+	template<typename _Ty1, typename _Term, reduce_form _Form>
+	inline reduce_result reduce_measure(const reduce_args& args)
+	{
+		using element = typename simd_traits<_Ty1>::element;
+
+		const element* x = static_cast<const element*>(args.x);
+		const element* y = static_cast<const element*>(args.y);
+
+		double           value = 0;
+		sandbox::sampler sampler(*args.sampling);
+		while (!sampler.done()) {
+			auto t0 = xmr::utility::profiler::clock::tsc::now();
+			if constexpr (_Form == reduce_form::naive) {
+				value = reduce_finish<_Ty1, _Term>(reduce_naive<_Ty1, _Term>(x, y, 0, args.count), false);
+			} else if constexpr (_Form == reduce_form::multi) {
+				value = reduce_finish<_Ty1, _Term>(reduce_multi<_Ty1, _Term>(x, y, 0, args.count), false);
+			} else if constexpr (_Form == reduce_form::pairwise) {
+				value = reduce_finish<_Ty1, _Term>(reduce_pairwise<_Ty1, _Term>(x, y, 0, args.count), false);
+			} else if constexpr (_Form == reduce_form::kahan) {
+				value = reduce_finish<_Ty1, _Term>(reduce_kahan<_Ty1, _Term>(x, y, 0, args.count), true);
+			} else if constexpr (_Form == reduce_form::neumaier) {
+				value = reduce_finish<_Ty1, _Term>(reduce_neumaier<_Ty1, _Term>(x, y, 0, args.count), true);
+			}
+			auto t1 = xmr::utility::profiler::clock::tsc::now();
+			sampler.add(sandbox::timer_subtract(t1 - t0, args.floor));
+			reduce_sink = value;
+		}
+		return {sampler.estimate(), value};
+	}
+
+	template<typename _Ty1, typename _Term>
+	inline reduce_result reduce_form_dispatch(const reduce_args& args)
+	{
+		switch (args.form) {
+		case reduce_form::naive:
+			return reduce_measure<_Ty1, _Term, reduce_form::naive>(args);
+		case reduce_form::multi:
+			return reduce_measure<_Ty1, _Term, reduce_form::multi>(args);
+		case reduce_form::pairwise:
+			return reduce_measure<_Ty1, _Term, reduce_form::pairwise>(args);
+		case reduce_form::kahan:
+			return reduce_measure<_Ty1, _Term, reduce_form::kahan>(args);
+		case reduce_form::neumaier:
+			return reduce_measure<_Ty1, _Term, reduce_form::neumaier>(args);
+		}
+		return {NAN, NAN};
+	}
+
+	template<typename _Ty1>
+	inline reduce_result reduce(const reduce_args& args)
+	{
+		// Both the operation and the form are template arguments, so the switches are resolved at compile time.
+		switch (args.op) {
+		case reduce_op::sum:
+			return reduce_form_dispatch<_Ty1, reduce_term_sum>(args);
+		case reduce_op::dot:
+			return reduce_form_dispatch<_Ty1, reduce_term_dot>(args);
+		case reduce_op::norm:
+			return reduce_form_dispatch<_Ty1, reduce_term_norm>(args);
+		}
+		return {NAN, NAN};
+	}
+} // namespace
+
+// One per instruction set, each in its own translation unit. The SSE one also covers scalar code.
+reduce_result reduce_sse(const reduce_args& args);
+reduce_result reduce_avx(const reduce_args& args);
+reduce_result reduce_avx512(const reduce_args& args);
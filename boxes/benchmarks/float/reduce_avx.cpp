@@ -0,0 +1,6 @@
+#include "reduce.hpp"
+
+reduce_result reduce_avx(const reduce_args& args)
+{
+	return args.f64 ? reduce<__m256d>(args) : reduce<__m256>(args);
+}
@@ -0,0 +1,6 @@
+#include "reduce.hpp"
+
+reduce_result reduce_avx512(const reduce_args& args)
+{
+	return args.f64 ? reduce<__m512d>(args) : reduce<__m512>(args);
+}
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <immintrin.h>
+
+// Profiler
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#include <sandbox/cpuid.hpp>
+#include <sandbox/thread.hpp>
+#include <sandbox/timer.hpp>
+#include <sandbox/topology.hpp>
+
+#include "float.hpp"
+#include "simd.hpp"
+
+/* Measure Multi-Core Scaling and Frequency Droop
+
+A single core running wide vectors is not what a busy machine looks like. With
+more cores active the package runs out of power and current headroom, and the
+clock drops, further so for AVX and AVX-512. The TSC keeps ticking at the same
+rate through all of it, so ticks alone do not show it.
+
+For every vector width and 1 to N physical cores:
+- Spin up one thread per core, pinned, and start them at the same time.
+- Every thread alternates a burst of the kernel with a short reference loop.
+- The reference loop is a chain of dependent integer adds, one cycle each, so
+  its length in TSC ticks gives the clock the core runs at right now.
+- Report GFLOP/s and GHz per core, their totals and minimums, and FLOPs per
+  cycle, which stays the same while the clock drops.
+
+The reference loop is calibrated on one idle core at startup: the difference
+between two lengths of it is exactly the extra adds, and what remains is the
+fixed cost of timing it. Only one thread runs per physical core, as SMT siblings
+share the FP units and the clock.
+*/
+
+#define SCALING_DURATION_MS 500
+#define SCALING_WARMUP_MS 100 // The clock takes a while to settle once wide instructions start.
+#define SCALING_ROUNDS 20000  // Several dozen microseconds of kernel between two reference loops.
+#define SCALING_REFERENCE_ADDS 10000
+#define SCALING_REFERENCE_UNROLL 100
+#define SCALING_CALIBRATION_SAMPLES 10000
+#define SCALING_SAMPLES 65536
+#define CACHE_LINE_SIZE 64
+
+// Keeps the reference loops of the calibration alive.
+static volatile uint64_t scaling_sink;
+
+// Read at runtime, so the adds take a register operand. Recent cores execute add with an immediate at register
+// rename without using a cycle, which would make the chain look several times faster than the clock.
+static volatile uint64_t reference_increment = 1;
+
+// One integer add the compiler can neither remove nor merge with the next one.
+static inline void reference_add(uint64_t& x, uint64_t increment)
+{
+#ifdef _MSC_VER
+	// MSVC has no inline assembly on x64, and does not merge these the way it would merge plain adds.
+	_addcarry_u64(0, x, increment, reinterpret_cast<unsigned long long*>(&x));
+#else
+	asm volatile("add %1, %0" : "+r"(x) : "r"(increment) : "cc");
+#endif
+}
+
+template<size_t... _Index>
+static inline void reference_step(uint64_t& x, uint64_t increment, std::index_sequence<_Index...>)
+{
+	((void(_Index), reference_add(x, increment)), ...);
+}
+
+// A chain of dependent integer adds, which take one cycle each at whatever clock the core runs.
+template<size_t _Adds>
+static uint64_t reference_chain()
+{
+	static_assert((_Adds % SCALING_REFERENCE_UNROLL) == 0, "The unroll factor must divide the number of adds.");
+
+	uint64_t x         = 0;
+	uint64_t increment = reference_increment;
+	for (size_t n = 0; n < (_Adds / SCALING_REFERENCE_UNROLL); n++) {
+		reference_step(x, increment, std::make_index_sequence<SCALING_REFERENCE_UNROLL>());
+	}
+	return x;
+}
+
+struct reference_calibration {
+	double overhead; // TSC ticks of a reference loop which are not adds.
+	double ghz;      // Clock of an idle core.
+};
+
+static reference_calibration reference_calibrate(double ns_per_tick)
+{
+	// The fastest of many runs, as nothing can make the chain shorter than it is.
+	uint64_t sink = 0, short_ticks = UINT64_MAX, long_ticks = UINT64_MAX;
+	for (size_t n = 0; n < SCALING_CALIBRATION_SAMPLES; n++) {
+		auto t0 = xmr::utility::profiler::clock::tsc::now();
+		sink += reference_chain<SCALING_REFERENCE_ADDS>();
+		auto t1 = xmr::utility::profiler::clock::tsc::now();
+		sink += reference_chain<SCALING_REFERENCE_ADDS * 2>();
+		auto t2 = xmr::utility::profiler::clock::tsc::now();
+
+		short_ticks = std::min<uint64_t>(short_ticks, t1 - t0);
+		long_ticks  = std::min<uint64_t>(long_ticks, t2 - t1);
+	}
+
+	double                ticks_per_add = double(long_ticks - std::min(short_ticks, long_ticks)) / double(SCALING_REFERENCE_ADDS);
+	reference_calibration calibration;
+	calibration.overhead = std::max(0.0, double(short_ticks) - ticks_per_add * double(SCALING_REFERENCE_ADDS));
+	calibration.ghz      = 1.0 / (ticks_per_add * ns_per_tick);
+	scaling_sink         = sink;
+	return calibration;
+}
+
+struct scaling_shared {
+	alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> arrived;
+	alignas(CACHE_LINE_SIZE) std::atomic<bool> start;
+	std::atomic<bool> measure;
+	std::atomic<bool> stop;
+};
+
+struct alignas(CACHE_LINE_SIZE) scaling_thread {
+	uint32_t        processor;
+	scaling_shared* shared;
+	double (*burst)(const simd_burst_args& args);
+	simd_burst_args args;
+
+	double                flops;
+	uint64_t              kernel_ticks;
+	uint64_t              sink;
+	std::vector<uint32_t> reference; // TSC ticks of each reference loop.
+};
+
+void scaling_main(scaling_thread* td)
+{
+	sandbox::thread_affinity(0, td->processor);
+	sandbox::thread_priority_rt();
+
+	scaling_shared* sd = td->shared;
+
+	// Wait for everyone else.
+	sd->arrived.fetch_add(1);
+	while (!sd->start.load(std::memory_order_acquire)) { // no-op
+	}
+
+	while (!sd->stop.load(std::memory_order_relaxed)) {
+		bool measure = sd->measure.load(std::memory_order_relaxed);
+
+		auto   t0    = xmr::utility::profiler::clock::tsc::now();
+		double flops = td->burst(td->args);
+		auto   t1    = xmr::utility::profiler::clock::tsc::now();
+		td->sink += reference_chain<SCALING_REFERENCE_ADDS>();
+		auto t2 = xmr::utility::profiler::clock::tsc::now();
+
+		if (measure) {
+			td->flops += flops;
+			td->kernel_ticks += t1 - t0;
+			if (td->reference.size() < SCALING_SAMPLES) {
+				td->reference.push_back(uint32_t(std::min<uint64_t>(t2 - t1, UINT32_MAX)));
+			}
+		}
+	}
+}
+
+struct scaling_result {
+	double gflops_avg; // Per core.
+	double gflops_min;
+	double gflops_total;
+	double ghz_avg; // Per core.
+	double ghz_min;
+};
+
+scaling_result scaling_run(double (*burst)(const simd_burst_args& args), const simd_burst_args& args, const std::vector<uint32_t>& processors, const reference_calibration& calibration,
+						   double ns_per_tick)
+{
+	scaling_shared sd;
+	sd.arrived = 0;
+	sd.start   = false;
+	sd.measure = false;
+	sd.stop    = false;
+
+	std::vector<scaling_thread> tds(processors.size());
+	std::vector<std::thread>    threads;
+	for (size_t n = 0; n < processors.size(); n++) {
+		tds[n].processor    = processors[n];
+		tds[n].shared       = &sd;
+		tds[n].burst        = burst;
+		tds[n].args         = args;
+		tds[n].flops        = 0;
+		tds[n].kernel_ticks = 0;
+		tds[n].sink         = 0;
+		tds[n].reference.reserve(SCALING_SAMPLES);
+		threads.emplace_back(scaling_main, &tds[n]);
+	}
+
+	// Start everyone at once, let the clock settle, and only then count.
+	while (sd.arrived.load() != processors.size()) {
+		std::this_thread::yield();
+	}
+	sd.start.store(true, std::memory_order_release);
+	std::this_thread::sleep_for(std::chrono::milliseconds(SCALING_WARMUP_MS));
+	sd.measure.store(true, std::memory_order_relaxed);
+	std::this_thread::sleep_for(std::chrono::milliseconds(SCALING_DURATION_MS));
+	sd.stop.store(true, std::memory_order_relaxed);
+
+	// Block by joining back together with the threads.
+	for (auto& thread : threads) {
+		if (thread.joinable())
+			thread.join();
+	}
+
+	scaling_result result = {0, 0, 0, 0, 0};
+	result.gflops_min     = double(UINT64_MAX);
+	result.ghz_min        = double(UINT64_MAX);
+	for (auto& td : tds) {
+		// The median reference loop, so an interrupt in a few of them does not count as a lower clock.
+		double ghz = 0;
+		if (!td.reference.empty()) {
+			std::nth_element(td.reference.begin(), td.reference.begin() + td.reference.size() / 2, td.reference.end());
+			double ticks = std::max(1.0, double(td.reference[td.reference.size() / 2]) - calibration.overhead);
+			ghz          = double(SCALING_REFERENCE_ADDS) / (ticks * ns_per_tick);
+		}
+		double gflops = td.kernel_ticks ? (td.flops / (double(td.kernel_ticks) * ns_per_tick)) : 0;
+
+		result.gflops_total += gflops;
+		result.gflops_min = std::min(result.gflops_min, gflops);
+		result.ghz_avg += ghz;
+		result.ghz_min = std::min(result.ghz_min, ghz);
+	}
+	result.gflops_avg = result.gflops_total / double(tds.size());
+	result.ghz_avg /= double(tds.size());
+
+	return result;
+}
+
+struct scaling_width {
+	const char* isa;
+	size_t      bits_f32;
+	size_t      bits_f64;
+	bool        available;
+	double (*burst)(const simd_burst_args& args);
+};
+
+static bool simd_kernel_parse(const char* name, simd_kernel& kernel)
+{
+	if (strcmp(name, "addsub") == 0) {
+		kernel = simd_kernel::addsub;
+	} else if (strcmp(name, "muladd") == 0) {
+		kernel = simd_kernel::muladd;
+	} else if (strcmp(name, "fma") == 0) {
+		kernel = simd_kernel::fma;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+static const char* simd_kernel_name(simd_kernel kernel)
+{
+	switch (kernel) {
+	case simd_kernel::addsub:
+		return "addsub";
+	case simd_kernel::muladd:
+		return "muladd";
+	case simd_kernel::fma:
+		return "fma";
+	}
+	return "unknown";
+}
+
+std::int32_t main_scaling(std::int32_t argc, const char* argv[])
+{
+	auto features = sandbox::cpuid_features();
+	bool has_fma  = features.avx2 && features.fma;
+
+	// FMA where the CPU has it, as that is what number crunching runs.
+	simd_kernel kernel = has_fma ? simd_kernel::fma : simd_kernel::muladd;
+	bool        f64    = false;
+	size_t      limit  = 0;
+	if (((argc > 1) && !simd_kernel_parse(argv[1], kernel)) || ((argc > 2) && (strcmp(argv[2], "f32") != 0) && (strcmp(argv[2], "f64") != 0))) {
+		printf("Usage: %s [addsub|muladd|fma] [f32|f64] [max cores]\n", argv[0]);
+		return 1;
+	}
+	if (argc > 2) {
+		f64 = strcmp(argv[2], "f64") == 0;
+	}
+	if (argc > 3) {
+		limit = size_t(strtoull(argv[3], nullptr, 10));
+	}
+
+	// One processor per physical core, nearest to core 0 first.
+	auto                  topology = sandbox::topology_detect();
+	std::vector<uint32_t> cores;
+	std::set<uint32_t>    seen;
+	for (auto id : sandbox::topology_order(topology, 0, sandbox::topology_policy::local, true)) {
+		if (seen.insert(topology[id].core).second) {
+			cores.push_back(id);
+		}
+	}
+	if ((limit > 0) && (limit < cores.size())) {
+		cores.resize(limit);
+	}
+
+	// Calibrate while nothing else is running yet, on a thread of its own so the coordinating thread does not stay on
+	// core 0 at real-time priority and compete with the worker measured there.
+	double                ns_per_tick = xmr::utility::profiler::clock::tsc::to_nanoseconds(1000000.0) / 1000000.0;
+	reference_calibration calibration;
+	std::thread([&calibration, ns_per_tick]() {
+		sandbox::thread_affinity(0, 0);
+		sandbox::thread_priority_rt();
+		calibration = reference_calibrate(ns_per_tick);
+	}).join();
+
+	// Scalar code has no FMA, and FMA on 128 and 256 bit registers came with AVX2.
+	std::vector<scaling_width> widths;
+	if (kernel == simd_kernel::fma) {
+		widths = {{"SSE", 128, 128, has_fma, simd_burst_fma}, {"AVX", 256, 256, has_fma, simd_burst_fma}, {"AVX-512", 512, 512, features.avx512f, simd_burst_avx512}};
+	} else {
+		widths = {{"Scalar", 32, 64, true, simd_burst_sse},
+				  {"SSE", 128, 128, true, simd_burst_sse},
+				  {"AVX", 256, 256, features.avx, simd_burst_avx},
+				  {"AVX-512", 512, 512, features.avx512f, simd_burst_avx512}};
+	}
+
+	std::ofstream file("scaling.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "isa,type,kernel,cores,gflops_per_core,gflops_min,gflops_total,ghz_per_core,ghz_min,ghz_idle,flops_per_cycle" << std::endl;
+
+	printf("%s\n", sandbox::cpuid_brand().c_str());
+	printf("Reference loop: %.3f GHz on one idle core, %.1f ticks of fixed overhead.\n", calibration.ghz, calibration.overhead);
+	printf("Running %s %s for %" PRIu32 "ms on 1 to %zu physical cores, GFLOP/s and GHz per core...\n", simd_kernel_name(kernel), f64 ? "F64" : "F32", uint32_t(SCALING_DURATION_MS), cores.size());
+	printf("ISA      | Cores |  GFLOP/s |   Min    |  Total   |  GHz  |  Min  | vs idle | FLOP/cyc\n");
+	printf("---------+-------+----------+----------+----------+-------+-------+---------+---------\n");
+	for (auto& width : widths) {
+		if (!width.available) {
+			printf("%-9s| not supported\n", width.isa);
+			continue;
+		}
+
+		simd_burst_args args;
+		args.kernel = kernel;
+		args.bits   = f64 ? width.bits_f64 : width.bits_f32;
+		args.f64    = f64;
+		args.rounds = SCALING_ROUNDS;
+
+		for (size_t k = 1; k <= cores.size(); k++) {
+			auto r = scaling_run(width.burst, args, std::vector<uint32_t>(cores.begin(), cores.begin() + k), calibration, ns_per_tick);
+
+			double droop           = r.ghz_avg / calibration.ghz - 1.0;
+			double flops_per_cycle = r.gflops_avg / r.ghz_avg;
+			printf("%-9s|%6zu |%9.2f |%9.2f |%9.2f |%6.3f |%6.3f |%+7.1f%% |%8.2f\n", width.isa, k, r.gflops_avg, r.gflops_min, r.gflops_total, r.ghz_avg, r.ghz_min, droop * 100.0,
+				   flops_per_cycle);
+			file << width.isa << "," << (f64 ? "F64" : "F32") << "," << simd_kernel_name(kernel) << "," << k << "," << r.gflops_avg << "," << r.gflops_min << "," << r.gflops_total << ","
+				 << r.ghz_avg << "," << r.ghz_min << "," << calibration.ghz << "," << flops_per_cycle << std::endl;
+		}
+	}
+	file.close();
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sandbox/cpuid.hpp>
+#include <sandbox/thread.hpp>
+
+#include "simd.hpp"
+
+/* Measure Throughput per Vector Width
+
+Wider vectors do more work per instruction, but they are not free: some CPUs
+lower their clock while wide instructions run, and some split them into two
+halves internally. Neither shows up in instruction tables.
+
+For every vector width the CPU and OS support, from scalar up to AVX-512:
+- Run add-sub, multiply-add and fused multiply-add on independent accumulators.
+- Report GFLOP/s in wall clock time, so a lower clock counts against the width.
+- Compare against scalar code of the same type. With perfect scaling the speedup
+  equals the number of lanes, anything less is lost to the clock or the units.
+*/
+
+size_t simd_run_sse(simd_result* results, const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	results[0] = {"Scalar", 32, false, simd_traits<float>::lanes, simd_measure<float, simd_addsub>(sampling, floor), simd_measure<float, simd_muladd>(sampling, floor), NAN};
+	results[1] = {"Scalar", 64, true, simd_traits<double>::lanes, simd_measure<double, simd_addsub>(sampling, floor), simd_measure<double, simd_muladd>(sampling, floor), NAN};
+	results[2] = {"SSE", 128, false, simd_traits<__m128>::lanes, simd_measure<__m128, simd_addsub>(sampling, floor), simd_measure<__m128, simd_muladd>(sampling, floor), NAN};
+	results[3] = {"SSE", 128, true, simd_traits<__m128d>::lanes, simd_measure<__m128d, simd_addsub>(sampling, floor), simd_measure<__m128d, simd_muladd>(sampling, floor), NAN};
+	return 4;
+}
+
+double simd_stream_sse(const simd_stream_args& args)
+{
+	if (args.bits == 128) {
+		return args.f64 ? simd_stream<__m128d>(args) : simd_stream<__m128>(args);
+	}
+	return args.f64 ? simd_stream<double>(args) : simd_stream<float>(args);
+}
+
+double simd_burst_sse(const simd_burst_args& args)
+{
+	if (args.bits == 128) {
+		return args.f64 ? simd_burst<__m128d>(args) : simd_burst<__m128>(args);
+	}
+	return args.f64 ? simd_burst<double>(args) : simd_burst<float>(args);
+}
+
+static std::string format_gflops(double value)
+{
+	if (std::isnan(value)) {
+		return "       -";
+	}
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%8.2f", value);
+	return buffer;
+}
+
+std::int32_t main_simd(std::int32_t argc, const char* argv[])
+{
+	sandbox::thread_affinity(0, 0);
+	sandbox::thread_priority_rt();
+
+	sandbox::timer_overhead floor = sandbox::timer_calibrate([]() { return xmr::utility::profiler::clock::tsc::now(); });
+
+	sandbox::sampling_options sampling;
+	sampling.statistic   = sandbox::sampling_statistic::mean;
+	sampling.target      = 0.005;
+	sampling.min_samples = 100;
+	sampling.max_samples = 100000;
+	sampling.interval    = 100;
+
+	auto features = sandbox::cpuid_features();
+	printf("%s\n", sandbox::cpuid_brand().c_str());
+	printf("SSE2: %s, AVX: %s, AVX2: %s, FMA: %s, AVX-512F: %s\n\n", features.sse2 ? "yes" : "no", features.avx ? "yes" : "no", features.avx2 ? "yes" : "no", features.fma ? "yes" : "no",
+		   features.avx512f ? "yes" : "no");
+
+	// Only run what this CPU can execute, the other translation units would crash with an illegal instruction.
+	std::vector<simd_result> results;
+	simd_result              buffer[SIMD_RESULTS_MAX];
+	results.insert(results.end(), buffer, buffer + simd_run_sse(buffer, sampling, floor.min));
+	if (features.avx) {
+		results.insert(results.end(), buffer, buffer + simd_run_avx(buffer, sampling, floor.min));
+	}
+	if (features.avx2 && features.fma) {
+		simd_run_fma(results.data(), results.size(), sampling, floor.min);
+	}
+	if (features.avx512f) {
+		results.insert(results.end(), buffer, buffer + simd_run_avx512(buffer, sampling, floor.min));
+	}
+
+	std::ofstream file("simd.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "isa,type,lanes,addsub,muladd,fma,speedup" << std::endl;
+
+	printf("GFLOP/s with %" PRIu64 " independent accumulators, speedup of +- over scalar code...\n", uint64_t(SIMD_ACCUMULATORS));
+	printf("ISA      | Type | Lanes |    +-    |    *+    |   FMA    | Speedup | Per lane\n");
+	printf("---------+------+-------+----------+----------+----------+---------+---------\n");
+	for (auto& result : results) {
+		// The scalar results of the same type are always the first two.
+		double scalar  = results[result.f64 ? 1 : 0].addsub;
+		double speedup = result.addsub / scalar;
+		printf("%-9s| %-5s|%6zu |%s  |%s  |%s  |%7.2fx |%7.1f%%\n", result.isa, result.f64 ? "F64" : "F32", result.lanes, format_gflops(result.addsub).c_str(), format_gflops(result.muladd).c_str(),
+			   format_gflops(result.fma).c_str(), speedup, speedup / double(result.lanes) * 100.0);
+		file << result.isa << "," << (result.f64 ? "F64" : "F32") << "," << result.lanes << "," << result.addsub << "," << result.muladd << "," << result.fma << "," << speedup << std::endl;
+	}
+	file.close();
+
+	return 0;
+}
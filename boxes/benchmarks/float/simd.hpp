@@ -0,0 +1,635 @@
+#pragma once
+#include <cinttypes>
+#include <cmath>
+#include <utility>
+#include <immintrin.h>
+
+// Profiler
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#include <sandbox/optimize.hpp>
+#include <sandbox/sampling.hpp>
+#include <sandbox/timer.hpp>
+
+#include "float.hpp"
+
+/* SIMD Kernels
+
+The same arithmetic as the scalar tests, at every vector width. Each width lives
+in its own translation unit compiled for that instruction set, and main_simd only
+calls the ones CPUID says are usable. This header is compiled into each of them.
+
+The operations are written with separate intrinsics, so the compiler must not
+contract a multiply and an add into an FMA on its own. All of these translation
+units are built with contraction disabled, and FMA is only measured with the
+explicit intrinsics.
+
+Anything with external linkage that more than one of these translation units
+instantiates, like a member of std::vector, is emitted by each of them, and the
+linker keeps whichever copy it sees first, which might use instructions the CPU
+does not have. So the kernels are in an anonymous namespace, and the entry
+points only fill in plain arrays, main_simd is the only one to touch containers.
+*/
+
+#define SIMD_ACCUMULATORS 12 // Enough to saturate two pipelined units, and still fits in 16 registers.
+#define SIMD_ROUNDS 1000
+#define SIMD_RESULTS_MAX 4 // Results one entry point writes at most.
+
+// GCC warns that the alignment attributes of the vector types are dropped in template arguments, which is harmless here.
+#ifndef _MSC_VER
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
+// GCC 12 also trips over the deliberately undefined pass-through operand of the AVX-512 square roots.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define SIMD_HAS_FMA
+#endif
+
+struct simd_result {
+	const char* isa;
+	size_t      bits; // Register width, or the element size for scalar code.
+	bool        f64;
+	size_t      lanes;
+	double      addsub; // GFLOP/s, NaN if not measured.
+	double      muladd;
+	double      fma;
+};
+
+enum class simd_stream_op {
+	add,    // x + x
+	mul,    // x * 0.75
+	muladd, // x * 0.75 + x
+	div,    // x / 1.25
+	sqrt,   // sqrt(x)
+};
+
+// One pass of an operation over an array, instead of a chain through registers.
+struct simd_stream_args {
+	simd_stream_op                   op;
+	size_t                           bits; // Register width, or the element size for scalar code.
+	bool                             f64;
+	const void*                      input;
+	void*                            output;
+	size_t                           count; // Elements, rounded down to whole registers.
+	const sandbox::sampling_options* sampling;
+	uint64_t                         floor;
+};
+
+enum class simd_kernel {
+	addsub, // (v + b) - a
+	muladd, // a + (v * b) as two instructions
+	fma,    // a + (v * b) as one fused instruction
+};
+
+// A fixed amount of register-only work without any timing, for running on many cores at once.
+struct simd_burst_args {
+	simd_kernel kernel;
+	size_t      bits; // Register width, or the element size for scalar code.
+	bool        f64;
+	size_t      rounds;
+};
+
+namespace {
+	template<typename _Ty1>
+	struct simd_traits;
+
+	template<>
+	struct simd_traits<float> {
+		using element = float;
+
+		static constexpr size_t lanes = 1;
+		static float            set1(double v)
+		{
+			return float(v);
+		}
+		static float add(float a, float b)
+		{
+			return a + b;
+		}
+		static float sub(float a, float b)
+		{
+			return a - b;
+		}
+		static float mul(float a, float b)
+		{
+			return a * b;
+		}
+		static float div(float a, float b)
+		{
+			return a / b;
+		}
+		static float sqrt(float a)
+		{
+			return std::sqrt(a);
+		}
+		static float load(const float* p)
+		{
+			return *p;
+		}
+		static void store(float* p, float v)
+		{
+			*p = v;
+		}
+	};
+
+	template<>
+	struct simd_traits<double> {
+		using element = double;
+
+		static constexpr size_t lanes = 1;
+		static double           set1(double v)
+		{
+			return v;
+		}
+		static double add(double a, double b)
+		{
+			return a + b;
+		}
+		static double sub(double a, double b)
+		{
+			return a - b;
+		}
+		static double mul(double a, double b)
+		{
+			return a * b;
+		}
+		static double div(double a, double b)
+		{
+			return a / b;
+		}
+		static double sqrt(double a)
+		{
+			return std::sqrt(a);
+		}
+		static double load(const double* p)
+		{
+			return *p;
+		}
+		static void store(double* p, double v)
+		{
+			*p = v;
+		}
+	};
+
+	template<>
+	struct simd_traits<__m128> {
+		using element = float;
+
+		static constexpr size_t lanes = 4;
+		static __m128           set1(double v)
+		{
+			return _mm_set1_ps(float(v));
+		}
+		static __m128 add(__m128 a, __m128 b)
+		{
+			return _mm_add_ps(a, b);
+		}
+		static __m128 sub(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(a, b);
+		}
+		static __m128 mul(__m128 a, __m128 b)
+		{
+			return _mm_mul_ps(a, b);
+		}
+		static __m128 div(__m128 a, __m128 b)
+		{
+			return _mm_div_ps(a, b);
+		}
+		static __m128 sqrt(__m128 a)
+		{
+			return _mm_sqrt_ps(a);
+		}
+		static __m128 load(const float* p)
+		{
+			return _mm_loadu_ps(p);
+		}
+		static void store(float* p, __m128 v)
+		{
+			_mm_storeu_ps(p, v);
+		}
+#ifdef SIMD_HAS_FMA
+		static __m128 fmadd(__m128 a, __m128 b, __m128 c)
+		{
+			return _mm_fmadd_ps(a, b, c);
+		}
+#endif
+	};
+
+	template<>
+	struct simd_traits<__m128d> {
+		using element = double;
+
+		static constexpr size_t lanes = 2;
+		static __m128d          set1(double v)
+		{
+			return _mm_set1_pd(v);
+		}
+		static __m128d add(__m128d a, __m128d b)
+		{
+			return _mm_add_pd(a, b);
+		}
+		static __m128d sub(__m128d a, __m128d b)
+		{
+			return _mm_sub_pd(a, b);
+		}
+		static __m128d mul(__m128d a, __m128d b)
+		{
+			return _mm_mul_pd(a, b);
+		}
+		static __m128d div(__m128d a, __m128d b)
+		{
+			return _mm_div_pd(a, b);
+		}
+		static __m128d sqrt(__m128d a)
+		{
+			return _mm_sqrt_pd(a);
+		}
+		static __m128d load(const double* p)
+		{
+			return _mm_loadu_pd(p);
+		}
+		static void store(double* p, __m128d v)
+		{
+			_mm_storeu_pd(p, v);
+		}
+#ifdef SIMD_HAS_FMA
+		static __m128d fmadd(__m128d a, __m128d b, __m128d c)
+		{
+			return _mm_fmadd_pd(a, b, c);
+		}
+#endif
+	};
+
+#ifdef __AVX__
+	template<>
+	struct simd_traits<__m256> {
+		using element = float;
+
+		static constexpr size_t lanes = 8;
+		static __m256           set1(double v)
+		{
+			return _mm256_set1_ps(float(v));
+		}
+		static __m256 add(__m256 a, __m256 b)
+		{
+			return _mm256_add_ps(a, b);
+		}
+		static __m256 sub(__m256 a, __m256 b)
+		{
+			return _mm256_sub_ps(a, b);
+		}
+		static __m256 mul(__m256 a, __m256 b)
+		{
+			return _mm256_mul_ps(a, b);
+		}
+		static __m256 div(__m256 a, __m256 b)
+		{
+			return _mm256_div_ps(a, b);
+		}
+		static __m256 sqrt(__m256 a)
+		{
+			return _mm256_sqrt_ps(a);
+		}
+		static __m256 load(const float* p)
+		{
+			return _mm256_loadu_ps(p);
+		}
+		static void store(float* p, __m256 v)
+		{
+			_mm256_storeu_ps(p, v);
+		}
+#ifdef SIMD_HAS_FMA
+		static __m256 fmadd(__m256 a, __m256 b, __m256 c)
+		{
+			return _mm256_fmadd_ps(a, b, c);
+		}
+#endif
+	};
+
+	template<>
+	struct simd_traits<__m256d> {
+		using element = double;
+
+		static constexpr size_t lanes = 4;
+		static __m256d          set1(double v)
+		{
+			return _mm256_set1_pd(v);
+		}
+		static __m256d add(__m256d a, __m256d b)
+		{
+			return _mm256_add_pd(a, b);
+		}
+		static __m256d sub(__m256d a, __m256d b)
+		{
+			return _mm256_sub_pd(a, b);
+		}
+		static __m256d mul(__m256d a, __m256d b)
+		{
+			return _mm256_mul_pd(a, b);
+		}
+		static __m256d div(__m256d a, __m256d b)
+		{
+			return _mm256_div_pd(a, b);
+		}
+		static __m256d sqrt(__m256d a)
+		{
+			return _mm256_sqrt_pd(a);
+		}
+		static __m256d load(const double* p)
+		{
+			return _mm256_loadu_pd(p);
+		}
+		static void store(double* p, __m256d v)
+		{
+			_mm256_storeu_pd(p, v);
+		}
+#ifdef SIMD_HAS_FMA
+		static __m256d fmadd(__m256d a, __m256d b, __m256d c)
+		{
+			return _mm256_fmadd_pd(a, b, c);
+		}
+#endif
+	};
+#endif
+
+#ifdef __AVX512F__
+	template<>
+	struct simd_traits<__m512> {
+		using element = float;
+
+		static constexpr size_t lanes = 16;
+		static __m512           set1(double v)
+		{
+			return _mm512_set1_ps(float(v));
+		}
+		static __m512 add(__m512 a, __m512 b)
+		{
+			return _mm512_add_ps(a, b);
+		}
+		static __m512 sub(__m512 a, __m512 b)
+		{
+			return _mm512_sub_ps(a, b);
+		}
+		static __m512 mul(__m512 a, __m512 b)
+		{
+			return _mm512_mul_ps(a, b);
+		}
+		static __m512 div(__m512 a, __m512 b)
+		{
+			return _mm512_div_ps(a, b);
+		}
+		static __m512 sqrt(__m512 a)
+		{
+			return _mm512_sqrt_ps(a);
+		}
+		static __m512 load(const float* p)
+		{
+			return _mm512_loadu_ps(p);
+		}
+		static void store(float* p, __m512 v)
+		{
+			_mm512_storeu_ps(p, v);
+		}
+		static __m512 fmadd(__m512 a, __m512 b, __m512 c)
+		{
+			return _mm512_fmadd_ps(a, b, c);
+		}
+	};
+
+	template<>
+	struct simd_traits<__m512d> {
+		using element = double;
+
+		static constexpr size_t lanes = 8;
+		static __m512d          set1(double v)
+		{
+			return _mm512_set1_pd(v);
+		}
+		static __m512d add(__m512d a, __m512d b)
+		{
+			return _mm512_add_pd(a, b);
+		}
+		static __m512d sub(__m512d a, __m512d b)
+		{
+			return _mm512_sub_pd(a, b);
+		}
+		static __m512d mul(__m512d a, __m512d b)
+		{
+			return _mm512_mul_pd(a, b);
+		}
+		static __m512d div(__m512d a, __m512d b)
+		{
+			return _mm512_div_pd(a, b);
+		}
+		static __m512d sqrt(__m512d a)
+		{
+			return _mm512_sqrt_pd(a);
+		}
+		static __m512d load(const double* p)
+		{
+			return _mm512_loadu_pd(p);
+		}
+		static void store(double* p, __m512d v)
+		{
+			_mm512_storeu_pd(p, v);
+		}
+		static __m512d fmadd(__m512d a, __m512d b, __m512d c)
+		{
+			return _mm512_fmadd_pd(a, b, c);
+		}
+	};
+#endif
+
+	// v = (v + b) - a, two FLOPs per lane.
+	struct simd_addsub {
+		template<typename _Ty1>
+		static _Ty1 apply(_Ty1 v, _Ty1 a, _Ty1 b)
+		{
+			return simd_traits<_Ty1>::sub(simd_traits<_Ty1>::add(v, b), a);
+		}
+	};
+
+	// v = a + (v * b) as two instructions, two FLOPs per lane.
+	struct simd_muladd {
+		template<typename _Ty1>
+		static _Ty1 apply(_Ty1 v, _Ty1 a, _Ty1 b)
+		{
+			return simd_traits<_Ty1>::add(a, simd_traits<_Ty1>::mul(v, b));
+		}
+	};
+
+	// v = a + (v * b) as one fused instruction, two FLOPs per lane.
+	struct simd_fmadd {
+		template<typename _Ty1>
+		static _Ty1 apply(_Ty1 v, _Ty1 a, _Ty1 b)
+		{
+			return simd_traits<_Ty1>::fmadd(v, b, a);
+		}
+	};
+
+	// Constant indices for everything that touches the accumulators, as a single variable index would keep the whole
+	// array in memory once do_not_optimize clobbers it.
+	template<typename _Ty1, size_t... _Index>
+	inline void simd_fill(_Ty1 (&acc)[sizeof...(_Index)], _Ty1 value, std::index_sequence<_Index...>)
+	{
+		((acc[_Index] = value), ...);
+	}
+
+	template<typename _Ty1, size_t... _Index>
+	inline void simd_keep(_Ty1 (&acc)[sizeof...(_Index)], std::index_sequence<_Index...>)
+	{
+		(sandbox::do_not_optimize(acc[_Index]), ...);
+	}
+
+	template<typename _Op, typename _Ty1, size_t... _Index>
+	inline void simd_step(_Ty1 (&acc)[sizeof...(_Index)], _Ty1 a, _Ty1 b, std::index_sequence<_Index...>)
+	{
+		((acc[_Index] = _Op::apply(acc[_Index], a, b), sandbox::do_not_optimize(acc[_Index])), ...);
+	}
+
+	// GFLOP/s of the operation on independent accumulators, which is the throughput of the FP units at this width.
+	template<typename _Ty1, typename _Op>
+	inline double simd_measure(const sandbox::sampling_options& sampling, uint64_t floor)
+	{
+		// Values stay in the normal range: v + 0.5 - 0.5 does not drift, and v * 0.5 + 0.5 converges to 1.
+		_Ty1 a = simd_traits<_Ty1>::set1(0.5);
+		_Ty1 b = simd_traits<_Ty1>::set1(0.5);
+		_Ty1 acc[SIMD_ACCUMULATORS];
+
+		sandbox::sampler sampler(sampling);
+		while (!sampler.done()) {
+			simd_fill(acc, simd_traits<_Ty1>::set1(1.0), std::make_index_sequence<SIMD_ACCUMULATORS>());
+
+			auto t0 = xmr::utility::profiler::clock::tsc::now();
+			for (size_t n = 0; n < SIMD_ROUNDS; n++) {
+				simd_step<_Op>(acc, a, b, std::make_index_sequence<SIMD_ACCUMULATORS>());
+			}
+			auto t1 = xmr::utility::profiler::clock::tsc::now();
+			sampler.add(sandbox::timer_subtract(t1 - t0, floor));
+		}
+
+		double flops = double(SIMD_ROUNDS) * SIMD_ACCUMULATORS * simd_traits<_Ty1>::lanes * 2.0;
+		return flops / xmr::utility::profiler::clock::tsc::to_nanoseconds(sampler.estimate());
+	}
+
+	// FLOPs done by the given number of rounds over all accumulators.
+	template<typename _Ty1, typename _Op>
+	inline double simd_burst_rounds(size_t rounds)
+	{
+		_Ty1 a = simd_traits<_Ty1>::set1(0.5);
+		_Ty1 b = simd_traits<_Ty1>::set1(0.5);
+		_Ty1 acc[SIMD_ACCUMULATORS];
+		simd_fill(acc, simd_traits<_Ty1>::set1(1.0), std::make_index_sequence<SIMD_ACCUMULATORS>());
+
+		for (size_t n = 0; n < rounds; n++) {
+			simd_step<_Op>(acc, a, b, std::make_index_sequence<SIMD_ACCUMULATORS>());
+		}
+
+		// Nothing reads the result, so the rounds could otherwise be removed.
+		simd_keep(acc, std::make_index_sequence<SIMD_ACCUMULATORS>());
+		return double(rounds) * SIMD_ACCUMULATORS * simd_traits<_Ty1>::lanes * 2.0;
+	}
+
+	// The kernels without FMA, which every translation unit can run.
+	template<typename _Ty1>
+	inline double simd_burst(const simd_burst_args& args)
+	{
+		switch (args.kernel) {
+		case simd_kernel::addsub:
+			return simd_burst_rounds<_Ty1, simd_addsub>(args.rounds);
+		case simd_kernel::muladd:
+			return simd_burst_rounds<_Ty1, simd_muladd>(args.rounds);
+		case simd_kernel::fma:
+			break;
+		}
+		return NAN;
+	}
+
+	template<typename _Ty1>
+	inline _Ty1 simd_stream_apply(simd_stream_op op, _Ty1 x)
+	{
+		using traits = simd_traits<_Ty1>;
+		switch (op) {
+		case simd_stream_op::add:
+			return traits::add(x, x);
+		case simd_stream_op::mul:
+			return traits::mul(x, traits::set1(0.75));
+		case simd_stream_op::muladd:
+			return traits::add(traits::mul(x, traits::set1(0.75)), x);
+		case simd_stream_op::div:
+			return traits::div(x, traits::set1(1.25));
+		case simd_stream_op::sqrt:
+			return traits::sqrt(x);
+		}
+		return x;
+	}
+
+	// TSC ticks per element for one pass over the input.
+	template<typename _Ty1, simd_stream_op _Op>
+	inline double simd_stream_measure(const simd_stream_args& args)
+	{
+		using traits  = simd_traits<_Ty1>;
+		using element = typename traits::element;
+
+		const element* input  = static_cast<const element*>(args.input);
+		element*       output = static_cast<element*>(args.output);
+		size_t         count  = args.count / traits::lanes * traits::lanes;
+
+		sandbox::sampler sampler(*args.sampling);
+		while (!sampler.done()) {
+			auto t0 = xmr::utility::profiler::clock::tsc::now();
+			for (size_t n = 0; n < count; n += traits::lanes) {
+				// Stops scalar code from being vectorized behind our back.
+				_Ty1 v = traits::load(input + n);
+				sandbox::do_not_optimize(v);
+				traits::store(output + n, simd_stream_apply(_Op, v));
+			}
+			auto t1 = xmr::utility::profiler::clock::tsc::now();
+			sampler.add(sandbox::timer_subtract(t1 - t0, args.floor));
+		}
+		return sampler.estimate() / double(count);
+	}
+
+	template<typename _Ty1>
+	inline double simd_stream(const simd_stream_args& args)
+	{
+		// The operation is a template argument, so the switch is resolved at compile time.
+		switch (args.op) {
+		case simd_stream_op::add:
+			return simd_stream_measure<_Ty1, simd_stream_op::add>(args);
+		case simd_stream_op::mul:
+			return simd_stream_measure<_Ty1, simd_stream_op::mul>(args);
+		case simd_stream_op::muladd:
+			return simd_stream_measure<_Ty1, simd_stream_op::muladd>(args);
+		case simd_stream_op::div:
+			return simd_stream_measure<_Ty1, simd_stream_op::div>(args);
+		case simd_stream_op::sqrt:
+			return simd_stream_measure<_Ty1, simd_stream_op::sqrt>(args);
+		}
+		return NAN;
+	}
+} // namespace
+
+// One per instruction set, each in its own translation unit. They write up to SIMD_RESULTS_MAX results and return how
+// many, except for FMA, which fills in the results of the other widths.
+size_t simd_run_sse(simd_result* results, const sandbox::sampling_options& sampling, uint64_t floor);
+size_t simd_run_avx(simd_result* results, const sandbox::sampling_options& sampling, uint64_t floor);
+void   simd_run_fma(simd_result* results, size_t count, const sandbox::sampling_options& sampling, uint64_t floor);
+size_t simd_run_avx512(simd_result* results, const sandbox::sampling_options& sampling, uint64_t floor);
+
+// The same, for streaming an operation over an array. The SSE one also covers scalar code.
+double simd_stream_sse(const simd_stream_args& args);
+double simd_stream_avx(const simd_stream_args& args);
+double simd_stream_avx512(const simd_stream_args& args);
+
+// The same, for a burst of work. They return the FLOPs done, or NaN for a kernel the translation unit can not run.
+double simd_burst_sse(const simd_burst_args& args);
+double simd_burst_avx(const simd_burst_args& args);
+double simd_burst_fma(const simd_burst_args& args);
+double simd_burst_avx512(const simd_burst_args& args);
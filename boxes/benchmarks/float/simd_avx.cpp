@@ -0,0 +1,18 @@
+#include "simd.hpp"
+
+size_t simd_run_avx(simd_result* results, const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	results[0] = {"AVX", 256, false, simd_traits<__m256>::lanes, simd_measure<__m256, simd_addsub>(sampling, floor), simd_measure<__m256, simd_muladd>(sampling, floor), NAN};
+	results[1] = {"AVX", 256, true, simd_traits<__m256d>::lanes, simd_measure<__m256d, simd_addsub>(sampling, floor), simd_measure<__m256d, simd_muladd>(sampling, floor), NAN};
+	return 2;
+}
+
+double simd_stream_avx(const simd_stream_args& args)
+{
+	return args.f64 ? simd_stream<__m256d>(args) : simd_stream<__m256>(args);
+}
+
+double simd_burst_avx(const simd_burst_args& args)
+{
+	return args.f64 ? simd_burst<__m256d>(args) : simd_burst<__m256>(args);
+}
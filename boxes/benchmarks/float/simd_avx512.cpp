@@ -0,0 +1,23 @@
+#include "simd.hpp"
+
+size_t simd_run_avx512(simd_result* results, const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	results[0] = {"AVX-512", 512, false, simd_traits<__m512>::lanes, simd_measure<__m512, simd_addsub>(sampling, floor), simd_measure<__m512, simd_muladd>(sampling, floor),
+				  simd_measure<__m512, simd_fmadd>(sampling, floor)};
+	results[1] = {"AVX-512", 512, true, simd_traits<__m512d>::lanes, simd_measure<__m512d, simd_addsub>(sampling, floor), simd_measure<__m512d, simd_muladd>(sampling, floor),
+				  simd_measure<__m512d, simd_fmadd>(sampling, floor)};
+	return 2;
+}
+
+double simd_stream_avx512(const simd_stream_args& args)
+{
+	return args.f64 ? simd_stream<__m512d>(args) : simd_stream<__m512>(args);
+}
+
+double simd_burst_avx512(const simd_burst_args& args)
+{
+	if (args.kernel == simd_kernel::fma) {
+		return args.f64 ? simd_burst_rounds<__m512d, simd_fmadd>(args.rounds) : simd_burst_rounds<__m512, simd_fmadd>(args.rounds);
+	}
+	return args.f64 ? simd_burst<__m512d>(args) : simd_burst<__m512>(args);
+}
@@ -0,0 +1,25 @@
+#include "simd.hpp"
+
+void simd_run_fma(simd_result* results, size_t count, const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	// FMA3 came with AVX2, and works on both 128 and 256 bit registers.
+	for (size_t n = 0; n < count; n++) {
+		simd_result& result = results[n];
+		if (result.bits == 128) {
+			result.fma = result.f64 ? simd_measure<__m128d, simd_fmadd>(sampling, floor) : simd_measure<__m128, simd_fmadd>(sampling, floor);
+		} else if (result.bits == 256) {
+			result.fma = result.f64 ? simd_measure<__m256d, simd_fmadd>(sampling, floor) : simd_measure<__m256, simd_fmadd>(sampling, floor);
+		}
+	}
+}
+
+double simd_burst_fma(const simd_burst_args& args)
+{
+	if (args.kernel != simd_kernel::fma) {
+		return NAN;
+	}
+	if (args.bits == 128) {
+		return args.f64 ? simd_burst_rounds<__m128d, simd_fmadd>(args.rounds) : simd_burst_rounds<__m128, simd_fmadd>(args.rounds);
+	}
+	return args.f64 ? simd_burst_rounds<__m256d, simd_fmadd>(args.rounds) : simd_burst_rounds<__m256, simd_fmadd>(args.rounds);
+}
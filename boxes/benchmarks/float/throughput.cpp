@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cinttypes>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+// Profiler
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#include <sandbox/optimize.hpp>
+#include <sandbox/sampling.hpp>
+#include <sandbox/thread.hpp>
+#include <sandbox/timer.hpp>
+
+#include "float.hpp"
+#include "operations.hpp"
+
+/* Measure Latency and Throughput
+
+The default benchmarks run a single dependent chain, so every operation waits
+for the previous one. That is the latency of the operation, not what batch math
+can get out of the FP units.
+
+For every operation and 1 to 16 accumulators:
+- Keep N independent accumulators in registers.
+- Apply the operation to each of them in turn, the same total number of times.
+- Report TSC ticks per operation, which are core cycles at the base clock.
+
+With one accumulator every operation waits for the previous one, which is the
+latency. More accumulators let the operations overlap, until the FP units are
+busy every cycle and adding more changes nothing. Where that happens is roughly
+latency times the number of units, and the best value is the throughput.
+*/
+
+#define THROUGHPUT_OPERATIONS 10080 // Divisible by every accumulator count up to 16 except 11 and 13.
+#define THROUGHPUT_MAX_ACCUMULATORS 16
+#define THROUGHPUT_SATURATION 0.05 // Within this fraction of the best counts as saturated.
+
+// Keeps the accumulators alive after the measurement.
+static volatile double throughput_sink;
+
+// Expands to one statement per accumulator, so every index is a constant and the array lives in registers.
+template<typename _Op, typename _Ty1, size_t _Accumulators, size_t... _Index>
+inline void chains_step(_Ty1 (&acc)[_Accumulators], std::index_sequence<_Index...>)
+{
+	((acc[_Index] = _Op::template apply<_Ty1>(acc[_Index]), sandbox::do_not_optimize(acc[_Index])), ...);
+}
+
+// Constant indices as well, as a single variable index would keep the whole array in memory.
+template<typename _Ty1, size_t _Accumulators, size_t... _Index>
+inline void chains_fill(_Ty1 (&acc)[_Accumulators], std::index_sequence<_Index...>)
+{
+	((acc[_Index] = _Ty1(OPERATION_START)), ...);
+}
+
+template<typename _Ty1, size_t _Accumulators, size_t... _Index>
+inline double chains_sum(_Ty1 (&acc)[_Accumulators], std::index_sequence<_Index...>)
+{
+	return (double(acc[_Index]) + ...);
+}
+
+// TSC ticks per operation with the given number of independent chains.
+template<typename _Ty1, typename _Op, size_t _Accumulators>
+double measure_chains(const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	constexpr size_t rounds = THROUGHPUT_OPERATIONS / _Accumulators;
+
+	sandbox::sampler sampler(sampling);
+	while (!sampler.done()) {
+		_Ty1 acc[_Accumulators];
+		chains_fill(acc, std::make_index_sequence<_Accumulators>());
+
+		auto t0 = xmr::utility::profiler::clock::tsc::now();
+		for (size_t n = 0; n < rounds; n++) {
+			chains_step<_Op>(acc, std::make_index_sequence<_Accumulators>());
+		}
+		auto t1 = xmr::utility::profiler::clock::tsc::now();
+
+		// Used before the next call, as no SSE register survives a call and the accumulators would be spilled to
+		// memory inside the loop instead.
+		throughput_sink = chains_sum(acc, std::make_index_sequence<_Accumulators>());
+		sampler.add(sandbox::timer_subtract(t1 - t0, floor));
+	}
+
+	return sampler.estimate() / double(rounds * _Accumulators);
+}
+
+template<typename _Ty1, typename _Op, size_t... _Accumulators>
+std::vector<double> sweep_chains(const sandbox::sampling_options& sampling, uint64_t floor, std::index_sequence<_Accumulators...>)
+{
+	// Braced initializers are evaluated in order, so the runs happen from 1 to 16.
+	return {measure_chains<_Ty1, _Op, _Accumulators + 1>(sampling, floor)...};
+}
+
+template<typename _Ty1, typename _Op>
+std::vector<double> sweep_chains(const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	return sweep_chains<_Ty1, _Op>(sampling, floor, std::make_index_sequence<THROUGHPUT_MAX_ACCUMULATORS>());
+}
+
+std::int32_t main_throughput(std::int32_t argc, const char* argv[])
+{
+	sandbox::thread_affinity(0, 0);
+	sandbox::thread_priority_rt();
+
+	sandbox::timer_overhead floor = sandbox::timer_calibrate([]() { return xmr::utility::profiler::clock::tsc::now(); });
+
+	sandbox::sampling_options sampling;
+	sampling.statistic   = sandbox::sampling_statistic::mean;
+	sampling.target      = 0.005;
+	sampling.min_samples = 100;
+	sampling.max_samples = 100000;
+	sampling.interval    = 100;
+
+	struct column {
+		const char*         name;
+		std::vector<double> ticks;
+	};
+	std::vector<column> columns;
+	columns.push_back({"F32 +-", sweep_chains<float, op_addsub>(sampling, floor.min)});
+	columns.push_back({"F64 +-", sweep_chains<double, op_addsub>(sampling, floor.min)});
+	columns.push_back({"F32 *+", sweep_chains<float, op_muladd>(sampling, floor.min)});
+	columns.push_back({"F64 *+", sweep_chains<double, op_muladd>(sampling, floor.min)});
+
+	std::ofstream file("throughput.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "accumulators";
+	for (auto& c : columns) {
+		file << "," << c.name;
+	}
+	file << std::endl;
+
+	printf("TSC ticks per operation with N independent accumulators, %" PRIu64 " operations per sample...\n", uint64_t(THROUGHPUT_OPERATIONS));
+	printf("  N ");
+	for (auto& c : columns) {
+		printf("| %-8s", c.name);
+	}
+	printf("\n----");
+	for (size_t n = 0; n < columns.size(); n++) {
+		printf("+---------");
+	}
+	printf("\n");
+	for (size_t n = 0; n < THROUGHPUT_MAX_ACCUMULATORS; n++) {
+		printf("%3zu ", n + 1);
+		file << (n + 1);
+		for (auto& c : columns) {
+			printf("|%8.3f ", c.ticks[n]);
+			file << "," << c.ticks[n];
+		}
+		printf("\n");
+		file << std::endl;
+	}
+	file.close();
+
+	// The first N within the tolerance of the best is where more independent work stops helping.
+	printf("\nTest      | Latency  | Through. | Ratio  | Saturates at\n");
+	printf("----------+----------+----------+--------+-------------\n");
+	for (auto& c : columns) {
+		double best       = *std::min_element(c.ticks.begin(), c.ticks.end());
+		size_t saturation = 0;
+		while (c.ticks[saturation] > (best * (1.0 + THROUGHPUT_SATURATION))) {
+			saturation++;
+		}
+		printf("%-10s|%8.3f  |%8.3f  |%6.2fx | %zu accumulators\n", c.name, c.ticks[0], best, c.ticks[0] / best, saturation + 1);
+	}
+
+	return 0;
+}
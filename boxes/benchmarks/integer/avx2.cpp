@@ -0,0 +1,9 @@
+#include "integer.hpp"
+#include "operations.hpp"
+
+size_t integer_run_avx2(integer_result* results, const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	static_assert(std::tuple_size_v<integer_avx2_operations> <= INTEGER_RESULTS_MAX, "Too many results for one entry point.");
+
+	return integer_run_all<__m256i>(results, "ymm", static_cast<const integer_avx2_operations*>(nullptr), sampling, floor);
+}
@@ -0,0 +1,10 @@
+#include "integer.hpp"
+#include "operations.hpp"
+
+size_t integer_run_bmi(integer_result* results, const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	static_assert(2 * std::tuple_size_v<integer_bmi_operations> <= INTEGER_RESULTS_MAX, "Too many results for one entry point.");
+
+	size_t count = integer_run_all<uint32_t>(results, "u32", static_cast<const integer_bmi_operations*>(nullptr), sampling, floor);
+	return count + integer_run_all<uint64_t>(results + count, "u64", static_cast<const integer_bmi_operations*>(nullptr), sampling, floor);
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cinttypes>
+#include <tuple>
+#include <utility>
+#include <immintrin.h>
+
+// Profiler
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#include <sandbox/optimize.hpp>
+#include <sandbox/sampling.hpp>
+#include <sandbox/timer.hpp>
+
+/* Integer Kernels
+
+The same measurement for every operation, compiled into the translation unit of
+the instruction set it needs. main only calls the ones CPUID says are usable.
+
+Every loop iteration applies INTEGER_CHAINS operations:
+- Latency: all of them to one chain, so each waits for the one before it.
+- Throughput: each to its own chain, so they can all run at the same time.
+
+Anything with external linkage that more than one of these translation units
+instantiates, like a member of std::vector, is emitted by each of them, and the
+linker keeps whichever copy it sees first, which might use instructions the CPU
+does not have. So the kernels are in an anonymous namespace, and the entry
+points only fill in plain arrays, main is the only one to touch containers.
+*/
+
+#define INTEGER_OPERATIONS 12000 // Per sample.
+#define INTEGER_CHAINS 12        // Enough to keep every port busy, and still fits into 16 registers.
+#define INTEGER_START 0x0123456789ABCDEFull
+#define INTEGER_RESULTS_MAX 32 // Results one entry point writes at most.
+
+struct integer_result {
+	const char* name;
+	const char* type;
+	double      latency;    // TSC ticks per operation.
+	double      throughput; // TSC ticks per operation.
+};
+
+namespace {
+	template<typename _Ty1>
+	inline _Ty1 integer_value(uint64_t value)
+	{
+		return _Ty1(value);
+	}
+
+#ifdef __AVX2__
+	template<>
+	inline __m256i integer_value<__m256i>(uint64_t value)
+	{
+		return _mm256_set1_epi64x(int64_t(value));
+	}
+#endif
+
+	// Expands to one statement per operation, so every index is a constant and the chains live in registers.
+	template<typename _Op, typename _Ty1, size_t _Chains, size_t... _Index>
+	inline void integer_step(_Ty1 (&acc)[_Chains], _Ty1 k, std::index_sequence<_Index...>)
+	{
+		((acc[_Index % _Chains] = _Op::template apply<_Ty1>(acc[_Index % _Chains], k), sandbox::do_not_optimize(acc[_Index % _Chains])), ...);
+	}
+
+	// Constant indices as well, as a single variable index would keep the whole array in memory.
+	template<typename _Ty1, size_t _Chains, size_t... _Index>
+	inline void integer_init(_Ty1 (&acc)[_Chains], std::index_sequence<_Index...>)
+	{
+		((acc[_Index] = integer_value<_Ty1>(INTEGER_START + _Index)), ...);
+	}
+
+	// TSC ticks per operation with the given number of independent chains.
+	template<typename _Ty1, typename _Op, size_t _Chains>
+	inline double integer_measure(const sandbox::sampling_options& sampling, uint64_t floor)
+	{
+		constexpr size_t rounds = INTEGER_OPERATIONS / INTEGER_CHAINS;
+
+		// Opaque to the compiler, so the operand is a register and not an immediate.
+		_Ty1 k = integer_value<_Ty1>(_Op::operand);
+		sandbox::do_not_optimize(k);
+
+		_Ty1 acc[_Chains];
+
+		sandbox::sampler sampler(sampling);
+		while (!sampler.done()) {
+			integer_init(acc, std::make_index_sequence<_Chains>());
+
+			auto t0 = xmr::utility::profiler::clock::tsc::now();
+			for (size_t n = 0; n < rounds; n++) {
+				integer_step<_Op>(acc, k, std::make_index_sequence<INTEGER_CHAINS>());
+			}
+			auto t1 = xmr::utility::profiler::clock::tsc::now();
+			sampler.add(sandbox::timer_subtract(t1 - t0, floor));
+		}
+		return sampler.estimate() / double(rounds * INTEGER_CHAINS);
+	}
+
+	// Every operation of a list, in order. Returns the number of results written.
+	template<typename _Ty1, typename... _Ops>
+	inline size_t integer_run_all(integer_result* results, const char* type, const std::tuple<_Ops...>*, const sandbox::sampling_options& sampling, uint64_t floor)
+	{
+		size_t count = 0;
+		((results[count++] = {_Ops::name, type, integer_measure<_Ty1, _Ops, 1>(sampling, floor), integer_measure<_Ty1, _Ops, INTEGER_CHAINS>(sampling, floor)}), ...);
+		return count;
+	}
+} // namespace
+
+// One per instruction set, each in its own translation unit. They write up to INTEGER_RESULTS_MAX results and return how many.
+size_t integer_run_base(integer_result* results, const sandbox::sampling_options& sampling, uint64_t floor);
+size_t integer_run_bmi(integer_result* results, const sandbox::sampling_options& sampling, uint64_t floor);
+size_t integer_run_avx2(integer_result* results, const sandbox::sampling_options& sampling, uint64_t floor);
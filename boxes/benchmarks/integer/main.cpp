@@ -0,0 +1,87 @@
+#include <cinttypes>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <sandbox/cpuid.hpp>
+#include <sandbox/thread.hpp>
+
+#include "integer.hpp"
+#include "operations.hpp"
+
+/* Measure Integer Latency and Throughput
+
+Hashing, index math and bit twiddling are integer code, and the instructions
+they use differ by an order of magnitude: an add takes a cycle, a 64 bit divide
+can take dozens, and some bit manipulation instructions are microcoded on some
+CPUs.
+
+For every operation and width the CPU supports:
+- Run one dependent chain, which is the latency.
+- Run independent chains, which is the throughput.
+- Report TSC ticks per operation, which are core cycles at the base clock.
+
+The ratio of the two is how many of the operation can be in flight at once. Any
+value above one means independent work can hide the latency.
+*/
+
+size_t integer_run_base(integer_result* results, const sandbox::sampling_options& sampling, uint64_t floor)
+{
+	static_assert(2 * std::tuple_size_v<integer_base_operations> <= INTEGER_RESULTS_MAX, "Too many results for one entry point.");
+
+	size_t count = integer_run_all<uint32_t>(results, "u32", static_cast<const integer_base_operations*>(nullptr), sampling, floor);
+	return count + integer_run_all<uint64_t>(results + count, "u64", static_cast<const integer_base_operations*>(nullptr), sampling, floor);
+}
+
+std::int32_t main(std::int32_t argc, const char* argv[])
+{
+	sandbox::thread_affinity(0, 0);
+	sandbox::thread_priority_rt();
+
+	sandbox::timer_overhead floor = sandbox::timer_calibrate([]() { return xmr::utility::profiler::clock::tsc::now(); });
+
+	sandbox::sampling_options sampling;
+	sampling.statistic   = sandbox::sampling_statistic::mean;
+	sampling.target      = 0.005;
+	sampling.min_samples = 100;
+	sampling.max_samples = 100000;
+	sampling.interval    = 100;
+
+	auto features = sandbox::cpuid_features();
+	bool bmi      = features.popcnt && features.lzcnt && features.bmi1 && features.bmi2;
+	printf("%s\n", sandbox::cpuid_brand().c_str());
+	printf("POPCNT: %s, LZCNT: %s, BMI1: %s, BMI2: %s, AVX2: %s\n\n", features.popcnt ? "yes" : "no", features.lzcnt ? "yes" : "no", features.bmi1 ? "yes" : "no", features.bmi2 ? "yes" : "no",
+		   features.avx2 ? "yes" : "no");
+
+	// Only run what this CPU can execute, the other translation units would crash with an illegal instruction.
+	std::vector<integer_result> results;
+	integer_result              buffer[INTEGER_RESULTS_MAX];
+	results.insert(results.end(), buffer, buffer + integer_run_base(buffer, sampling, floor.min));
+	if (bmi) {
+		results.insert(results.end(), buffer, buffer + integer_run_bmi(buffer, sampling, floor.min));
+	}
+	if (features.avx2) {
+		results.insert(results.end(), buffer, buffer + integer_run_avx2(buffer, sampling, floor.min));
+	}
+
+	std::ofstream file("integer.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "op,type,latency,throughput" << std::endl;
+
+	printf("TSC ticks per operation, one chain for the latency and %" PRIu64 " for the throughput...\n", uint64_t(INTEGER_CHAINS));
+	printf("Op        | Type | Latency  | Through. | In flight\n");
+	printf("----------+------+----------+----------+----------\n");
+	for (auto& result : results) {
+		printf("%-10s| %-5s|%8.3f  |%8.3f  |%8.2fx\n", result.name, result.type, result.latency, result.throughput, result.latency / result.throughput);
+		file << result.name << "," << result.type << "," << result.latency << "," << result.throughput << std::endl;
+	}
+	if (!bmi) {
+		printf("%-10s| not supported\n", "BMI");
+	}
+	if (!features.avx2) {
+		printf("%-10s| not supported\n", "AVX2");
+	}
+	file.close();
+
+	std::cin.get();
+	return 0;
+}
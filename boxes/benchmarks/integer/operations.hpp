@@ -0,0 +1,274 @@
+#pragma once
+#include <cinttypes>
+#include <tuple>
+#include <immintrin.h>
+
+/* Operations
+
+Every operation is one step of a dependency chain: it takes the previous value
+and an operand, and returns the next value. The operand is kept opaque to the
+compiler, so it is always a register and never an immediate. Recent cores
+execute some instructions with an immediate at register rename, which would hide
+the latency of the execution unit.
+
+Instructions which can not chain on their own, like a count that always returns
+a small number, are combined with an xor or an or. Those add one cycle of
+latency to the step, and one more operation to the throughput.
+
+Every instruction set extension has its own list, the benchmark loops and the
+reporting are generated from them. Only the translation unit compiled for an
+extension instantiates its operations.
+*/
+
+// General purpose instructions every x86-64 CPU has.
+struct int_add {
+	static constexpr const char* name    = "add";
+	static constexpr uint64_t    operand = 1;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return v + k;
+	}
+};
+
+struct int_imul {
+	static constexpr const char* name    = "imul";
+	static constexpr uint64_t    operand = 0x9E3779B97F4A7C15ull; // Odd, so no bits are lost.
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return v * k;
+	}
+};
+
+// The top bit is always set, so every division has a full width dividend. The or adds a cycle.
+struct int_div {
+	static constexpr const char* name    = "div";
+	static constexpr uint64_t    operand = 7;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return (v | (_Ty1(1) << (sizeof(_Ty1) * 8 - 1))) / k;
+	}
+};
+
+// Shifts by a register count. The value ends up as zero, which does not change their latency.
+struct int_shl {
+	static constexpr const char* name    = "shl";
+	static constexpr uint64_t    operand = 1;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return v << k;
+	}
+};
+
+struct int_shr {
+	static constexpr const char* name    = "shr";
+	static constexpr uint64_t    operand = 1;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return v >> k;
+	}
+};
+
+// Compilers turn this pattern into a single rotate.
+struct int_rol {
+	static constexpr const char* name    = "rol";
+	static constexpr uint64_t    operand = 7;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return (v << k) | (v >> ((sizeof(_Ty1) * 8 - k) & (sizeof(_Ty1) * 8 - 1)));
+	}
+};
+
+using integer_base_operations = std::tuple<int_add, int_imul, int_div, int_shl, int_shr, int_rol>;
+
+// POPCNT, LZCNT, BMI1 and BMI2.
+struct int_popcnt {
+	static constexpr const char* name    = "popcnt";
+	static constexpr uint64_t    operand = 0x5555555555555555ull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		if constexpr (sizeof(_Ty1) == 8) {
+			return _Ty1(_mm_popcnt_u64(v)) ^ k;
+		} else {
+			return _Ty1(_mm_popcnt_u32(v)) ^ k;
+		}
+	}
+};
+
+struct int_lzcnt {
+	static constexpr const char* name    = "lzcnt";
+	static constexpr uint64_t    operand = 0x00F0F0F0F0F0F0F0ull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		if constexpr (sizeof(_Ty1) == 8) {
+			return _Ty1(_lzcnt_u64(v)) ^ k;
+		} else {
+			return _Ty1(_lzcnt_u32(v)) ^ k;
+		}
+	}
+};
+
+struct int_tzcnt {
+	static constexpr const char* name    = "tzcnt";
+	static constexpr uint64_t    operand = 0x0F0F0F0F0F0F0F00ull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		if constexpr (sizeof(_Ty1) == 8) {
+			return _Ty1(_tzcnt_u64(v)) ^ k;
+		} else {
+			return _Ty1(_tzcnt_u32(v)) ^ k;
+		}
+	}
+};
+
+struct int_pext {
+	static constexpr const char* name    = "pext";
+	static constexpr uint64_t    operand = 0x00FF00FF00FF00FFull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		if constexpr (sizeof(_Ty1) == 8) {
+			return _Ty1(_pext_u64(v, k)) ^ k;
+		} else {
+			return _Ty1(_pext_u32(v, k)) ^ k;
+		}
+	}
+};
+
+struct int_pdep {
+	static constexpr const char* name    = "pdep";
+	static constexpr uint64_t    operand = 0x00FF00FF00FF00FFull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		if constexpr (sizeof(_Ty1) == 8) {
+			return _Ty1(_pdep_u64(v, k)) ^ k;
+		} else {
+			return _Ty1(_pdep_u32(v, k)) ^ k;
+		}
+	}
+};
+
+using integer_bmi_operations = std::tuple<int_popcnt, int_lzcnt, int_tzcnt, int_pext, int_pdep>;
+
+// AVX2 on 256 bit registers. The operand is repeated in every 64 bit lane.
+struct vec_paddd {
+	static constexpr const char* name    = "vpaddd";
+	static constexpr uint64_t    operand = 0x0000000100000001ull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return _mm256_add_epi32(v, k);
+	}
+};
+
+struct vec_paddq {
+	static constexpr const char* name    = "vpaddq";
+	static constexpr uint64_t    operand = 1;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return _mm256_add_epi64(v, k);
+	}
+};
+
+struct vec_pmulld {
+	static constexpr const char* name    = "vpmulld";
+	static constexpr uint64_t    operand = 0x9E3779B19E3779B1ull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return _mm256_mullo_epi32(v, k);
+	}
+};
+
+struct vec_pmuludq {
+	static constexpr const char* name    = "vpmuludq";
+	static constexpr uint64_t    operand = 0x000000009E3779B1ull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return _mm256_mul_epu32(v, k);
+	}
+};
+
+struct vec_pmaddwd {
+	static constexpr const char* name    = "vpmaddwd";
+	static constexpr uint64_t    operand = 0x0001000100010001ull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return _mm256_madd_epi16(v, k);
+	}
+};
+
+struct vec_psllvd {
+	static constexpr const char* name    = "vpsllvd";
+	static constexpr uint64_t    operand = 0x0000000100000001ull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return _mm256_sllv_epi32(v, k);
+	}
+};
+
+struct vec_psrlvq {
+	static constexpr const char* name    = "vpsrlvq";
+	static constexpr uint64_t    operand = 1;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return _mm256_srlv_epi64(v, k);
+	}
+};
+
+// A byte shuffle, which takes the same time for every pattern.
+struct vec_pshufb {
+	static constexpr const char* name    = "vpshufb";
+	static constexpr uint64_t    operand = 0x0007060504030201ull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return _mm256_shuffle_epi8(v, k);
+	}
+};
+
+struct vec_pminud {
+	static constexpr const char* name    = "vpminud";
+	static constexpr uint64_t    operand = 0x7FFFFFFF7FFFFFFFull;
+
+	template<typename _Ty1>
+	static _Ty1 apply(_Ty1 v, _Ty1 k)
+	{
+		return _mm256_min_epu32(v, k);
+	}
+};
+
+using integer_avx2_operations = std::tuple<vec_paddd, vec_paddq, vec_pmulld, vec_pmuludq, vec_pmaddwd, vec_psllvd, vec_psrlvq, vec_pshufb, vec_pminud>;
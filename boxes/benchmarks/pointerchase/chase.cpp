@@ -0,0 +1,166 @@
+#include "chase.hpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#define CHASE_LINE_SIZE 64
+#define CHASE_PAGE_SIZE 4096
+#define CHASE_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+#define CHASE_1 p = reinterpret_cast<void**>(*p);
+#define CHASE_4 CHASE_1 CHASE_1 CHASE_1 CHASE_1
+#define CHASE_16 CHASE_4 CHASE_4 CHASE_4 CHASE_4
+
+#ifndef WIN32
+// From linux/mempolicy.h, which is all we need from libnuma.
+#define CHASE_MPOL_BIND 2
+#define CHASE_MPOL_MF_STRICT (1 << 0)
+#define CHASE_MPOL_MF_MOVE (1 << 1)
+
+static bool numa_bind(void* data, size_t size, uint32_t node)
+{
+	// One bit per node, and the kernel wants the number of bits plus one.
+	std::vector<unsigned long> mask((node / (sizeof(unsigned long) * 8)) + 1, 0);
+	mask[node / (sizeof(unsigned long) * 8)] |= 1ul << (node % (sizeof(unsigned long) * 8));
+	return syscall(SYS_mbind, data, size, CHASE_MPOL_BIND, mask.data(), mask.size() * sizeof(unsigned long) * 8 + 1, CHASE_MPOL_MF_STRICT | CHASE_MPOL_MF_MOVE) == 0;
+}
+#endif
+
+// Keeps the final pointer alive, so the chain can not be optimized away.
+static void* volatile chase_sink;
+
+chase_buffer::chase_buffer(size_t size, bool huge_pages, int32_t node) : _data(nullptr), _size(size), _pages(chase_pages::normal)
+{
+#ifdef WIN32
+	DWORD  preferred = (node >= 0) ? DWORD(node) : NUMA_NO_PREFERRED_NODE;
+	HANDLE process   = GetCurrentProcess();
+	if (huge_pages) {
+		// Requires SeLockMemoryPrivilege, silently fall back without it.
+		size_t large = GetLargePageMinimum();
+		if (large != 0) {
+			size_t rounded = (size + large - 1) & ~(large - 1);
+			_data          = VirtualAllocExNuma(process, nullptr, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, preferred);
+			if (_data) {
+				_size  = rounded;
+				_pages = chase_pages::huge;
+				return;
+			}
+		}
+	}
+	_data = VirtualAllocExNuma(process, nullptr, _size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, preferred);
+#else
+	if (huge_pages) {
+		// Explicit huge pages only work if some have been reserved in /proc/sys/vm/nr_hugepages.
+		size_t rounded = (size + CHASE_HUGE_PAGE_SIZE - 1) & ~size_t(CHASE_HUGE_PAGE_SIZE - 1);
+		void*  data    = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (data != MAP_FAILED) {
+			_data  = data;
+			_size  = rounded;
+			_pages = chase_pages::huge;
+		}
+	}
+
+	if (!_data) {
+		void* data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data == MAP_FAILED) {
+			return;
+		}
+		_data = data;
+
+		if (huge_pages && (madvise(_data, _size, MADV_HUGEPAGE) == 0)) {
+			_pages = chase_pages::transparent;
+		}
+	}
+
+	// Nothing has been touched yet, so every page will be faulted in on the node.
+	if ((node >= 0) && !numa_bind(_data, _size, uint32_t(node))) {
+		munmap(_data, _size);
+		_data = nullptr;
+	}
+#endif
+}
+
+chase_buffer::~chase_buffer()
+{
+	if (!_data) {
+		return;
+	}
+#ifdef WIN32
+	VirtualFree(_data, 0, MEM_RELEASE);
+#else
+	munmap(_data, _size);
+#endif
+}
+
+const char* chase_pages_name(chase_pages pages)
+{
+	switch (pages) {
+	case chase_pages::normal:
+		return "normal";
+	case chase_pages::transparent:
+		return "transparent huge";
+	case chase_pages::huge:
+		return "huge";
+	}
+	return "unknown";
+}
+
+size_t chase_stride_size(chase_stride stride)
+{
+	return (stride == chase_stride::page) ? CHASE_PAGE_SIZE : CHASE_LINE_SIZE;
+}
+
+void** chase_build(void* buffer, size_t working_set, chase_stride stride, uint64_t seed)
+{
+	size_t step     = chase_stride_size(stride);
+	size_t elements = std::max<size_t>(working_set / step, 1);
+
+	// Sattolo's algorithm: a random permutation that is a single cycle through all elements.
+	std::mt19937_64       rng(seed);
+	std::vector<uint32_t> next(elements);
+	for (size_t n = 0; n < elements; n++) {
+		next[n] = uint32_t(n);
+	}
+	for (size_t n = elements - 1; n > 0; n--) {
+		std::swap(next[n], next[std::uniform_int_distribution<size_t>(0, n - 1)(rng)]);
+	}
+
+	// With page stride every element sits at a random line of its page, so they do not all map to the same cache set.
+	std::vector<uint32_t> offset(elements, 0);
+	if (stride == chase_stride::page) {
+		std::uniform_int_distribution<uint32_t> line(0, (CHASE_PAGE_SIZE / CHASE_LINE_SIZE) - 1);
+		for (auto& value : offset) {
+			value = line(rng) * CHASE_LINE_SIZE;
+		}
+	}
+
+	char* base = reinterpret_cast<char*>(buffer);
+	for (size_t n = 0; n < elements; n++) {
+		*reinterpret_cast<void**>(base + n * step + offset[n]) = base + size_t(next[n]) * step + offset[next[n]];
+	}
+	return reinterpret_cast<void**>(base + offset[0]);
+}
+
+uint64_t chase_run(void** start, size_t loads)
+{
+	void** p  = start;
+	auto   t0 = xmr::utility::profiler::clock::tsc::now();
+	for (size_t n = loads / 16; n > 0; n--) {
+		CHASE_16;
+	}
+	auto t1    = xmr::utility::profiler::clock::tsc::now();
+	chase_sink = p;
+	return t1 - t0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cinttypes>
+#include <cstddef>
+
+/* Pointer Chasing
+
+Every element of the buffer holds the address of the next one, so each load
+depends on the one before it and the CPU can not overlap them. The time per
+load is then the load-to-use latency of wherever the working set lives.
+
+The elements form a single random cycle, which defeats the hardware prefetchers
+and makes sure every element is visited once per pass.
+*/
+
+enum class chase_stride {
+	line, // One element per cache line.
+	page, // One element per page, at a random line within the page.
+};
+
+enum class chase_pages {
+	normal,      // Regular pages.
+	transparent, // Regular allocation, with the kernel asked to back it with huge pages.
+	huge,        // Explicit huge pages.
+};
+
+// Page aligned memory, optionally backed by huge pages and bound to a NUMA node.
+class chase_buffer {
+	void*       _data;
+	size_t      _size;
+	chase_pages _pages;
+
+	public:
+	// Falls back to smaller pages if huge pages are not available, check pages() for what was used.
+	// A node of -1 leaves placement to the system, otherwise the allocation fails if it can not be bound.
+	chase_buffer(size_t size, bool huge_pages, int32_t node = -1);
+	~chase_buffer();
+
+	chase_buffer(const chase_buffer&)            = delete;
+	chase_buffer& operator=(const chase_buffer&) = delete;
+
+	// Null if the allocation failed.
+	void* data() const
+	{
+		return _data;
+	}
+
+	size_t size() const
+	{
+		return _size;
+	}
+
+	chase_pages pages() const
+	{
+		return _pages;
+	}
+};
+
+const char* chase_pages_name(chase_pages pages);
+
+// Size of one element step, in bytes.
+size_t chase_stride_size(chase_stride stride);
+
+// Link one element per stride of the first working_set bytes into a single random cycle, returning its start.
+void** chase_build(void* buffer, size_t working_set, chase_stride stride, uint64_t seed);
+
+// Follow the cycle for the given number of loads, returning the TSC ticks it took.
+uint64_t chase_run(void** start, size_t loads);
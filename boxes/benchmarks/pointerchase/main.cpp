@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Profiler
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#include <sandbox/thread.hpp>
+
+#include "chase.hpp"
+#include "pointerchase.hpp"
+
+/* Measure Memory Latency
+
+Per-thread buffers should fit into the cache level they are meant for, which
+needs the load-to-use latency for every working set size, and where it jumps.
+
+For every working set size, from 4 KiB up to the maximum:
+- Link one element per cache line (or page) into a single random cycle.
+- Chase the pointers once to warm up caches and TLB.
+- Chase them for a fixed number of loads, a few times, and keep the fastest.
+
+Each cache level shows up as a plateau of similar latencies, followed by a rise
+once the working set no longer fits. The largest working set on a plateau is a
+lower bound for the size of that level, as some of it is always used by other
+data and lost to imperfect replacement.
+
+With page stride every load also needs a new TLB entry, so it shows the TLB
+reach rather than the caches. Huge pages remove most of the TLB misses.
+*/
+
+#define CHASE_MIN_SIZE (4ull * 1024)
+#define CHASE_MAX_SIZE (4096ull * 1024 * 1024)
+#define CHASE_STEPS_PER_OCTAVE 4
+#define CHASE_LOADS (4 * 1024 * 1024)
+#define CHASE_REPEATS 3
+#define CHASE_PLATEAU_TOLERANCE 0.2
+
+struct chase_point {
+	size_t size;
+	double latency; // Nanoseconds per load.
+};
+
+struct chase_plateau {
+	size_t first;
+	size_t last;
+	double latency;
+};
+
+static std::string format_size(size_t size)
+{
+	const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+	double      value   = double(size);
+	size_t      unit    = 0;
+	while ((value >= 1024.0) && ((unit + 1) < std::size(units))) {
+		value /= 1024.0;
+		unit++;
+	}
+
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.4g %s", value, units[unit]);
+	return buffer;
+}
+
+// Split the sweep into runs of points within the tolerance of the first point of the run.
+// Single points between two runs are part of a transition, and do not count as a plateau.
+// Neighbouring runs within the tolerance of each other are one plateau with a slow rise.
+static std::vector<chase_plateau> detect_plateaus(const std::vector<chase_point>& points)
+{
+	std::vector<std::pair<size_t, size_t>> runs;
+	for (size_t n = 0; n < points.size();) {
+		size_t end = n + 1;
+		while ((end < points.size()) && (points[end].latency <= (points[n].latency * (1.0 + CHASE_PLATEAU_TOLERANCE)))) {
+			end++;
+		}
+
+		if ((end - n) >= 2) {
+			if (!runs.empty() && (points[n].latency <= (points[runs.back().second - 1].latency * (1.0 + CHASE_PLATEAU_TOLERANCE)))) {
+				runs.back().second = end;
+			} else {
+				runs.push_back({n, end});
+			}
+		}
+		n = end;
+	}
+
+	std::vector<chase_plateau> plateaus;
+	for (auto& run : runs) {
+		// The median is less sensitive to the gradual rise towards the next level.
+		std::vector<double> latencies;
+		for (size_t n = run.first; n < run.second; n++) {
+			latencies.push_back(points[n].latency);
+		}
+		std::sort(latencies.begin(), latencies.end());
+		plateaus.push_back({points[run.first].size, points[run.second - 1].size, latencies[latencies.size() / 2]});
+	}
+	return plateaus;
+}
+
+std::int32_t main(std::int32_t argc, const char* argv[])
+{
+	// Select the mode to run, defaulting to the working set sweep.
+	if ((argc > 1) && (strcmp(argv[1], "numa") == 0)) {
+		return main_numa(argc - 1, argv + 1);
+	}
+
+	chase_stride stride     = chase_stride::line;
+	bool         huge_pages = false;
+	size_t       max_size   = CHASE_MAX_SIZE;
+	for (std::int32_t n = 1; n < argc; n++) {
+		if (strcmp(argv[n], "line") == 0) {
+			stride = chase_stride::line;
+		} else if (strcmp(argv[n], "page") == 0) {
+			stride = chase_stride::page;
+		} else if (strcmp(argv[n], "huge") == 0) {
+			huge_pages = true;
+		} else if ((max_size = size_t(strtoull(argv[n], nullptr, 10)) * 1024 * 1024) == 0) {
+			printf("Usage: %s [line|page] [huge] [max size in MiB]\n       %s numa [huge] [size in MiB]\n", argv[0], argv[0]);
+			return 1;
+		}
+	}
+
+	sandbox::thread_affinity(0, 0);
+	sandbox::thread_priority_rt();
+
+	// Allocate the largest working set once, and shrink it if the system can not provide it.
+	size_t                        step = chase_stride_size(stride);
+	std::unique_ptr<chase_buffer> buffer;
+	for (; max_size >= CHASE_MIN_SIZE; max_size /= 2) {
+		buffer = std::make_unique<chase_buffer>(max_size, huge_pages);
+		if (buffer->data()) {
+			break;
+		}
+	}
+	if (!buffer || !buffer->data()) {
+		printf("Failed to allocate memory.\n");
+		return 1;
+	}
+
+	// Sizes grow geometrically, and never hold fewer than 16 elements.
+	std::vector<size_t> sizes;
+	for (size_t n = 0;; n++) {
+		size_t size = size_t(double(CHASE_MIN_SIZE) * std::pow(2.0, double(n) / CHASE_STEPS_PER_OCTAVE)) / step * step;
+		if (size > max_size) {
+			break;
+		}
+		if ((size >= (step * 16)) && (sizes.empty() || (sizes.back() != size))) {
+			sizes.push_back(size);
+		}
+	}
+
+	std::ofstream file("pointerchase.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "size,latency" << std::endl;
+
+	printf("Chasing %" PRIu64 " loads per size, %zu byte stride, %s pages, up to %s...\n", uint64_t(CHASE_LOADS), step, chase_pages_name(buffer->pages()), format_size(max_size).c_str());
+	printf("Size        | Latency\n");
+	printf("------------+-----------\n");
+	std::vector<chase_point> points;
+	for (size_t size : sizes) {
+		void** start = chase_build(buffer->data(), size, stride, size);
+
+		// Warm up with one full pass, or as much of it as the measurement would do anyway.
+		chase_run(start, std::min<size_t>(size / step, CHASE_LOADS) + 16);
+
+		uint64_t best = UINT64_MAX;
+		for (size_t n = 0; n < CHASE_REPEATS; n++) {
+			best = std::min(best, chase_run(start, CHASE_LOADS));
+		}
+
+		double latency = xmr::utility::profiler::clock::tsc::to_nanoseconds(double(best)) / double(CHASE_LOADS);
+		points.push_back({size, latency});
+		printf("%-12s|%8.2f ns\n", format_size(size).c_str(), latency);
+		file << size << "," << latency << std::endl;
+	}
+	file.close();
+
+	// The last plateau is main memory, as long as the sweep went far enough past the last cache.
+	auto plateaus = detect_plateaus(points);
+	printf("\nDetected %zu levels:\n", plateaus.size());
+	printf("Level  | Fits up to  | Latency\n");
+	printf("-------+-------------+-----------\n");
+	for (size_t n = 0; n < plateaus.size(); n++) {
+		std::string name = ((n + 1) == plateaus.size()) && (n > 0) ? "Memory" : ("L" + std::to_string(n + 1));
+		std::string size = ((n + 1) == plateaus.size()) && (n > 0) ? "-" : format_size(plateaus[n].last);
+		printf("%-7s| %-12s|%8.2f ns\n", name.c_str(), size.c_str(), plateaus[n].latency);
+	}
+
+	std::cin.get();
+	return 0;
+}
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+#define XMR_UTILITY_PROFILER_ENABLE_FORCEINLINE
+#include <xmr/utility/profiler/clock/tsc.hpp>
+
+#include <sandbox/thread.hpp>
+#include <sandbox/topology.hpp>
+
+#include "chase.hpp"
+#include "pointerchase.hpp"
+
+/* Measure NUMA Latency and Bandwidth
+
+Memory attached to another node is further away, both in latency and in the
+bandwidth the interconnect can provide. The default sweep only ever sees the
+memory the system picked for it.
+
+For every node with processors and every node with memory:
+- Pin the thread to the first processor of the processor node.
+- Allocate a buffer bound to the memory node, before anything touches it.
+- Chase pointers through the whole buffer for the latency.
+- Stream through the whole buffer for the read bandwidth.
+
+Binding uses the mbind system call directly on Linux, and VirtualAllocExNuma on
+Windows, so no NUMA library is needed. Nodes without processors, like memory
+expanders, still show up as memory nodes.
+*/
+
+#define NUMA_SIZE (512ull * 1024 * 1024)
+#define NUMA_LOADS (4 * 1024 * 1024)
+#define NUMA_REPEATS 3
+
+// Keeps the sums alive, so the stream can not be optimized away.
+static volatile uint64_t numa_sink;
+
+// Read every byte of the buffer, returning the TSC ticks it took.
+static uint64_t numa_stream(const void* buffer, size_t size)
+{
+	const uint64_t* data = reinterpret_cast<const uint64_t*>(buffer);
+	uint64_t        sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+
+	auto t0 = xmr::utility::profiler::clock::tsc::now();
+	for (size_t n = 0, end = size / sizeof(uint64_t); (n + 4) <= end; n += 4) {
+		sum0 += data[n];
+		sum1 += data[n + 1];
+		sum2 += data[n + 2];
+		sum3 += data[n + 3];
+	}
+	auto t1 = xmr::utility::profiler::clock::tsc::now();
+
+	numa_sink = sum0 + sum1 + sum2 + sum3;
+	return t1 - t0;
+}
+
+// Nodes which have memory attached, whether or not they have processors.
+static std::vector<uint32_t> numa_memory_nodes(const std::vector<sandbox::topology_processor>& topology)
+{
+	std::vector<uint32_t> nodes;
+#ifdef WIN32
+	ULONG highest = 0;
+	if (GetNumaHighestNodeNumber(&highest)) {
+		for (ULONG node = 0; node <= highest; node++) {
+			ULONGLONG bytes = 0;
+			if (GetNumaAvailableMemoryNodeEx(USHORT(node), &bytes) && (bytes > 0)) {
+				nodes.push_back(uint32_t(node));
+			}
+		}
+	}
+#else
+	// A list of ranges, like "0-1,4".
+	std::ifstream file("/sys/devices/system/node/has_memory");
+	std::string   line;
+	if (file.good() && std::getline(file, line)) {
+		for (const char* cur = line.c_str(); *cur;) {
+			char*    end   = nullptr;
+			uint32_t first = uint32_t(strtoul(cur, &end, 10));
+			uint32_t last  = first;
+			if (end == cur) {
+				break;
+			}
+			if (*end == '-') {
+				last = uint32_t(strtoul(end + 1, &end, 10));
+			}
+			for (uint32_t node = first; node <= last; node++) {
+				nodes.push_back(node);
+			}
+			cur = (*end == ',') ? (end + 1) : end;
+		}
+	}
+#endif
+
+	// Without any information, every node with processors also has memory.
+	if (nodes.empty()) {
+		for (auto& processor : topology) {
+			if (std::find(nodes.begin(), nodes.end(), processor.node) == nodes.end()) {
+				nodes.push_back(processor.node);
+			}
+		}
+		std::sort(nodes.begin(), nodes.end());
+	}
+	return nodes;
+}
+
+std::int32_t main_numa(std::int32_t argc, const char* argv[])
+{
+	bool   huge_pages = false;
+	size_t size       = NUMA_SIZE;
+	for (std::int32_t n = 1; n < argc; n++) {
+		if (strcmp(argv[n], "huge") == 0) {
+			huge_pages = true;
+		} else if ((size = size_t(strtoull(argv[n], nullptr, 10)) * 1024 * 1024) == 0) {
+			printf("Usage: numa [huge] [size in MiB]\n");
+			return 1;
+		}
+	}
+
+	// The first processor of every node represents it.
+	auto                         topology = sandbox::topology_detect();
+	std::map<uint32_t, uint32_t> cpu_nodes;
+	for (auto& processor : topology) {
+		cpu_nodes.emplace(processor.node, processor.id);
+	}
+	auto memory_nodes = numa_memory_nodes(topology);
+
+	std::ofstream file("numa.csv", std::ios_base::out | std::ios_base::trunc);
+	file << "cpu node,memory node,latency,bandwidth" << std::endl;
+
+	printf("Testing %zu processor nodes against %zu memory nodes with %" PRIu64 " MiB each...\n", cpu_nodes.size(), memory_nodes.size(), uint64_t(size / 1024 / 1024));
+	printf("CPU  | Memory | Latency    | Bandwidth\n");
+	printf("-----+--------+------------+-------------\n");
+	std::map<std::pair<uint32_t, uint32_t>, std::pair<double, double>> results;
+	for (auto& cpu_node : cpu_nodes) {
+		sandbox::thread_affinity(0, cpu_node.second);
+		sandbox::thread_priority_rt();
+
+		for (uint32_t memory_node : memory_nodes) {
+			chase_buffer buffer(size, huge_pages, int32_t(memory_node));
+			if (!buffer.data()) {
+				printf("%4" PRIu32 " | %6" PRIu32 " | failed to allocate and bind memory\n", cpu_node.first, memory_node);
+				continue;
+			}
+
+			// Latency, with one full pass to warm up the TLB.
+			void** start = chase_build(buffer.data(), buffer.size(), chase_stride::line, memory_node);
+			chase_run(start, NUMA_LOADS);
+			uint64_t best_chase = UINT64_MAX;
+			for (size_t n = 0; n < NUMA_REPEATS; n++) {
+				best_chase = std::min(best_chase, chase_run(start, NUMA_LOADS));
+			}
+
+			// Bandwidth, from the same (already faulted in) buffer.
+			numa_stream(buffer.data(), buffer.size());
+			uint64_t best_stream = UINT64_MAX;
+			for (size_t n = 0; n < NUMA_REPEATS; n++) {
+				best_stream = std::min(best_stream, numa_stream(buffer.data(), buffer.size()));
+			}
+
+			double latency   = xmr::utility::profiler::clock::tsc::to_nanoseconds(double(best_chase)) / double(NUMA_LOADS);
+			double bandwidth = double(buffer.size()) / xmr::utility::profiler::clock::tsc::to_nanoseconds(double(best_stream)); // GB/s
+			results[{cpu_node.first, memory_node}] = {latency, bandwidth};
+			printf("%4" PRIu32 " | %6" PRIu32 " |%8.1f ns |%8.2f GB/s\n", cpu_node.first, memory_node, latency, bandwidth);
+			file << cpu_node.first << "," << memory_node << "," << latency << "," << bandwidth << std::endl;
+		}
+	}
+	file.close();
+
+	// Matrices, processor nodes down and memory nodes across.
+	for (size_t table = 0; table < 2; table++) {
+		printf("\n%s\n CPU |", (table == 0) ? "Latency (ns)" : "Bandwidth (GB/s)");
+		for (uint32_t memory_node : memory_nodes) {
+			printf(" %8" PRIu32 " |", memory_node);
+		}
+		printf("\n");
+		for (auto& cpu_node : cpu_nodes) {
+			printf("%4" PRIu32 " |", cpu_node.first);
+			for (uint32_t memory_node : memory_nodes) {
+				auto itr = results.find({cpu_node.first, memory_node});
+				if (itr == results.end()) {
+					printf("          |");
+				} else {
+					printf(" %8.2f |", (table == 0) ? itr->second.first : itr->second.second);
+				}
+			}
+			printf("\n");
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <cinttypes>
+
+/* Modes
+
+Every mode is a standalone entry point which receives the remaining arguments,
+with argv[0] being the name of the mode itself.
+*/
+
+// Measure latency and bandwidth from every NUMA node with processors to every node with memory.
+std::int32_t main_numa(std::int32_t argc, const char* argv[]);
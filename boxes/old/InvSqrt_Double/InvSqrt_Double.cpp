@@ -20,6 +20,9 @@
 #include <windows.h>
 #endif
 
+#include <sandbox/cpuid.hpp>
+#include "InvSqrt_Double.hpp"
+
 // Math
 double invsqrt(double v) {
     return 1.0 / sqrt(v);
@@ -408,6 +411,38 @@ int main(int argc, const char** argv) {
 	TESTMULTI("Q3 InvSqrt SSE (256 Ops)", invsqrt_q3_sse256, 256);
 	TESTMULTI("Q3 InvSqrt SSE (512 Ops)", invsqrt_q3_sse512, 512);
 
+	// Only run what this CPU can execute, the other kernels would crash with an illegal instruction.
+	auto features = sandbox::cpuid_features();
+	if (features.avx512f) {
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+		TESTMULTI("RSqrt14 AVX-512 (8 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 8, 8>), 8);
+		TESTMULTI("RSqrt14 AVX-512 (16 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 8, 16>), 16);
+		TESTMULTI("RSqrt14 AVX-512 (32 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 8, 32>), 32);
+		TESTMULTI("RSqrt14 AVX-512 (64 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 8, 64>), 64);
+		TESTMULTI("RSqrt14 AVX-512 (128 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 8, 128>), 128);
+		TESTMULTI("RSqrt14 AVX-512 (256 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 8, 256>), 256);
+		TESTMULTI("RSqrt14 AVX-512 (512 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 8, 512>), 512);
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+		TESTMULTI("RSqrt14 AVX-512 NR1 (8 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 8, 8>), 8);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (16 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 8, 16>), 16);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (32 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 8, 32>), 32);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (64 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 8, 64>), 64);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (128 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 8, 128>), 128);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (256 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 8, 256>), 256);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (512 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 8, 512>), 512);
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+		TESTMULTI("RSqrt14 AVX-512 NR2 (8 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 8, 8>), 8);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (16 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 8, 16>), 16);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (32 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 8, 32>), 32);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (64 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 8, 64>), 64);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (128 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 8, 128>), 128);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (256 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 8, 256>), 256);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (512 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 8, 512>), 512);
+	} else {
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+		printLog("| %-30s | %-18s | %13s | %14s |", "RSqrt14 AVX-512", "not supported", "", "");
+	}
+
 	csvfile.close();
 
     #ifdef _WIN32
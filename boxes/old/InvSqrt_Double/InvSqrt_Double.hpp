@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+
+// Hardware approximation of 1/sqrt(v) with 0, 1 or 2 Newton-Raphson steps, 8 doubles at a time.
+// Needs AVX-512F, see InvSqrt_Double_AVX512.cpp.
+void invsqrt_rsqrt14_avx512(double* v);
+void invsqrt_rsqrt14_nr1_avx512(double* v);
+void invsqrt_rsqrt14_nr2_avx512(double* v);
+
+// Calls a kernel of the given width until Count doubles are done.
+template<void (*Function)(double*), size_t Width, size_t Count>
+void invsqrt_repeat(double* v) {
+	for (size_t n = 0; n < Count; n += Width) {
+		Function(v + n);
+	}
+}
@@ -0,0 +1,32 @@
+#include <immintrin.h>
+#include "InvSqrt_Double.hpp"
+
+// Compiled with AVX-512F enabled, only call these if CPUID reports it.
+
+// _mm512_rsqrt14_pd is good for 14 bits, and every Newton-Raphson step
+//   y = y * (1.5 - 0.5 * v * y * y)
+// roughly doubles that: 28 bits after one, and close to the 53 bits of a
+// double after two.
+template<size_t Steps>
+static inline __m512d rsqrt14_avx512(__m512d value) {
+	const __m512d zero_point_five = _mm512_set1_pd(0.5);
+	const __m512d one_point_five = _mm512_set1_pd(1.5);
+
+	__m512d result = _mm512_rsqrt14_pd(value);
+	__m512d halfvalue = _mm512_mul_pd(value, zero_point_five);
+	for (size_t step = 0; step < Steps; step++) {
+		__m512d correction = _mm512_fnmadd_pd(_mm512_mul_pd(halfvalue, result), result, one_point_five); // 1.5 - (x2 * y * y)
+		result = _mm512_mul_pd(result, correction);
+	}
+	return result;
+}
+
+void invsqrt_rsqrt14_avx512(double* v) {
+	_mm512_storeu_pd(v, rsqrt14_avx512<0>(_mm512_loadu_pd(v)));
+}
+void invsqrt_rsqrt14_nr1_avx512(double* v) {
+	_mm512_storeu_pd(v, rsqrt14_avx512<1>(_mm512_loadu_pd(v)));
+}
+void invsqrt_rsqrt14_nr2_avx512(double* v) {
+	_mm512_storeu_pd(v, rsqrt14_avx512<2>(_mm512_loadu_pd(v)));
+}
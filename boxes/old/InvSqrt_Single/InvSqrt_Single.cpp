@@ -10,10 +10,19 @@
 //#include <ofstream>
 #include <thread>
 #include <random>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #ifdef _WIN32
 #include <windows.h>
 #endif
 
+#include <sandbox/cpuid.hpp>
+#include "InvSqrt_Single.hpp"
+
 // Standard Math
 float invsqrt(float v) {
 	return 1.0f / sqrtf(v);
@@ -57,27 +66,22 @@ void invsqrt512(float* v) {
 
 // SSE Math
 float invsqrt_sse(float v) {
-	__m128 mv = _mm_set_ps(v, 0, 0, 0);
-	const __m128 dv = _mm_set_ps(1.0f, 0, 0, 0);
-	auto sv = _mm_sqrt_ps(mv);
-	sv = _mm_div_ps(dv, sv);
-	float result;
-	_mm_store1_ps(&result, sv);
-	return result;
+	__m128 mv = _mm_set_ss(v); // Lane 0, which is also the one _mm_cvtss_f32 reads.
+	const __m128 dv = _mm_set_ss(1.0f);
+	auto sv = _mm_sqrt_ss(mv);
+	sv = _mm_div_ss(dv, sv);
+	return _mm_cvtss_f32(sv);
 }
 void invsqrt_sse2(float* v) {
 	const __m128 dv = _mm_set_ps(1.0f, 1.0f, 1.0f, 1.0f);
-	__m128 mv = _mm_set_ps(v[0], v[1], 0, 0);
+	__m128 mv = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)v); // Only two floats, in the low lanes.
 	mv = _mm_sqrt_ps(mv);
 	mv = _mm_div_ps(dv, mv);
-	float result[4];
-	_mm_storeu_ps(result, mv);
-	v[0] = result[0];
-	v[1] = result[1];
+	_mm_storel_pi((__m64*)v, mv);
 }
 void invsqrt_sse4(float* v) {
 	const __m128 dv = _mm_set_ps(1.0f, 1.0f, 1.0f, 1.0f);
-	__m128 mv = _mm_set_ps(v[0], v[1], v[2], v[3]);
+	__m128 mv = _mm_loadu_ps(v); // _mm_set_ps would reverse the order.
 	mv = _mm_sqrt_ps(mv);
 	mv = _mm_div_ps(dv, mv);
 	_mm_storeu_ps(v, mv);
@@ -111,22 +115,25 @@ void invsqrt_sse512(float* v) {
 	invsqrt_sse256(v + 256);
 }
 
+#define CARMACK_CONSTANT 0x5F3759DF
+#define LOMONT_CONSTANT 0x5F375A86 // Chris Lomont
+
 #define USE_LOMONT_CONSTANT
 #ifndef USE_LOMONT_CONSTANT
-#define FASTINVSQRT 0x5F3759DF // Carmack
+#define FASTINVSQRT CARMACK_CONSTANT
 #else
-#define FASTINVSQRT 0x5F375A86 // Chris Lomont
+#define FASTINVSQRT LOMONT_CONSTANT
 #endif
 
 // Quake III
 float invsqrt_q3(float v) {
 	union {
 		float f;
-		long u;
+		int32_t u; // long is 64 bits on Linux.
 	} y = { v };
 	float x2 = v * 0.5f;
 	y.u = FASTINVSQRT - (y.u >> 1);
-	y.f = (1.5f - (x2 * y.f * y.f));
+	y.f = y.f * (1.5f - (x2 * y.f * y.f));
 	return y.f;
 }
 void invsqrt_q32(float* v) {
@@ -167,69 +174,72 @@ void invsqrt_q3512(float* v) {
 }
 
 float invsqrt_q3_sse(float v) {
-	const __m128i magic_constant = _mm_set_epi32(FASTINVSQRT, 0, 0, 0);
-	const __m128 zero_point_five = _mm_set_ps(0.5f, 0, 0, 0);
-	const __m128 one_point_five = _mm_set_ps(1.5f, 0, 0, 0);
+	const __m128i magic_constant = _mm_cvtsi32_si128(FASTINVSQRT);
+	const __m128 zero_point_five = _mm_set_ss(0.5f);
+	const __m128 one_point_five = _mm_set_ss(1.5f);
 
-	__m128 value = _mm_set_ps(v, 0, 0, 0); // y.f = v
+	__m128 value = _mm_set_ss(v); // y.f = v, in lane 0.
 	__m128 halfvalue = _mm_mul_ps(value, zero_point_five); // x2 = v * 0.5f
 	__m128i ivalue = _mm_castps_si128(value); // y.u (union) y.f
 	ivalue = _mm_srai_epi32(ivalue, 1); // y.u >> 1
 	ivalue = _mm_sub_epi32(magic_constant, ivalue); // FASTINVSQRT - (y.u >> 1)
-	value = _mm_castsi128_ps(ivalue); // y.f (union) y.u
+	__m128 estimate = _mm_castsi128_ps(ivalue); // y.f (union) y.u
 
-	// y.f = 1.5f - (x2 * y.f * y.f) part
-	value = _mm_mul_ps(value, value); // y.f * y.f
+	// y.f = y.f * (1.5f - (x2 * y.f * y.f)) part
+	value = _mm_mul_ps(estimate, estimate); // y.f * y.f
 	value = _mm_mul_ps(value, halfvalue); // x2 * y.f * y.f
 	value = _mm_sub_ps(one_point_five, value); // 1.5f - (x2 * y.f * y.f)
+	value = _mm_mul_ps(estimate, value); // y.f * (1.5f - (x2 * y.f * y.f))
 
-	float result;
-	_mm_store1_ps(&result, value);
-	return result;
+	return _mm_cvtss_f32(value);
 }
 void invsqrt_q3_sse2(float* v) {
-	const __m128i magic_constant = _mm_set_epi32(FASTINVSQRT, FASTINVSQRT, 0, 0);
-	const __m128 zero_point_five = _mm_set_ps(0.5f, 0.5f, 0, 0);
-	const __m128 one_point_five = _mm_set_ps(1.5f, 1.5f, 0, 0);
+	const __m128i magic_constant = _mm_set_epi32(0, 0, FASTINVSQRT, FASTINVSQRT);
+	const __m128 zero_point_five = _mm_set_ps(0, 0, 0.5f, 0.5f);
+	const __m128 one_point_five = _mm_set_ps(0, 0, 1.5f, 1.5f);
 
-	__m128 value = _mm_set_ps(v[0], v[1], 0, 0); // y.f = v
+	__m128 value = _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)v); // y.f = v, only two floats, in the low lanes.
 	__m128 halfvalue = _mm_mul_ps(value, zero_point_five); // x2 = v * 0.5f
 	__m128i ivalue = _mm_castps_si128(value); // y.u (union) y.f
 	ivalue = _mm_srai_epi32(ivalue, 1); // y.u >> 1
 	ivalue = _mm_sub_epi32(magic_constant, ivalue); // FASTINVSQRT - (y.u >> 1)
-	value = _mm_castsi128_ps(ivalue); // y.f (union) y.u
+	__m128 estimate = _mm_castsi128_ps(ivalue); // y.f (union) y.u
 
-	// y.f = 1.5f - (x2 * y.f * y.f) part
-	value = _mm_mul_ps(value, value); // y.f * y.f
+	// y.f = y.f * (1.5f - (x2 * y.f * y.f)) part
+	value = _mm_mul_ps(estimate, estimate); // y.f * y.f
 	value = _mm_mul_ps(value, halfvalue); // x2 * y.f * y.f
 	value = _mm_sub_ps(one_point_five, value); // 1.5f - (x2 * y.f * y.f)
+	value = _mm_mul_ps(estimate, value); // y.f * (1.5f - (x2 * y.f * y.f))
 
 	// result
-	float result[4];
-	_mm_storeu_ps(v, value);
-	v[0] = result[0];
-	v[1] = result[1];
+	_mm_storel_pi((__m64*)v, value);
 }
-void invsqrt_q3_sse4(float* v) {
-	const __m128i magic_constant = _mm_set_epi32(FASTINVSQRT, FASTINVSQRT, FASTINVSQRT, FASTINVSQRT);
+// The constant is a parameter, so the accuracy sweep can compare them.
+template<int32_t Magic>
+void invsqrt_q3_sse4_with(float* v) {
+	const __m128i magic_constant = _mm_set_epi32(Magic, Magic, Magic, Magic);
 	const __m128 zero_point_five = _mm_set_ps(0.5f, 0.5f, 0.5f, 0.5f);
 	const __m128 one_point_five = _mm_set_ps(1.5f, 1.5f, 1.5f, 1.5f);
 
-	__m128 value = _mm_set_ps(v[0], v[1], v[2], v[3]); // y.f = v
+	__m128 value = _mm_loadu_ps(v); // y.f = v, _mm_set_ps would reverse the order.
 	__m128 halfvalue = _mm_mul_ps(value, zero_point_five); // x2 = v * 0.5f
 	__m128i ivalue = _mm_castps_si128(value); // y.u (union) y.f
 	ivalue = _mm_srai_epi32(ivalue, 1); // y.u >> 1
 	ivalue = _mm_sub_epi32(magic_constant, ivalue); // FASTINVSQRT - (y.u >> 1)
-	value = _mm_castsi128_ps(ivalue); // y.f (union) y.u
+	__m128 estimate = _mm_castsi128_ps(ivalue); // y.f (union) y.u
 
-	// y.f = 1.5f - (x2 * y.f * y.f) part
-	value = _mm_mul_ps(value, value); // y.f * y.f
+	// y.f = y.f * (1.5f - (x2 * y.f * y.f)) part
+	value = _mm_mul_ps(estimate, estimate); // y.f * y.f
 	value = _mm_mul_ps(value, halfvalue); // x2 * y.f * y.f
 	value = _mm_sub_ps(one_point_five, value); // 1.5f - (x2 * y.f * y.f)
+	value = _mm_mul_ps(estimate, value); // y.f * (1.5f - (x2 * y.f * y.f))
 
 	// result
 	_mm_storeu_ps(v, value);
 }
+void invsqrt_q3_sse4(float* v) {
+	invsqrt_q3_sse4_with<FASTINVSQRT>(v);
+}
 void invsqrt_q3_sse8(float* v) {
 	invsqrt_q3_sse4(v);
 	invsqrt_q3_sse4(v + 4);
@@ -342,6 +352,219 @@ void printScore(const char* name, uint64_t timeNanoSeconds, uint64_t testSize, s
 	}
 }
 
+// Accuracy
+// Every kernel is run over all 2^32 float bit patterns, and compared to 1/sqrt in double precision, which is exact
+// enough to be the reference for floats. The error is measured over the positive normal inputs, every other input is
+// checked for the result IEEE 754 gives it.
+#define SWEEP_BLOCK 512 // Floats per kernel call, the size of the widest speed test.
+#define SWEEP_CHUNK (1ull << 20) // Bit patterns per work item, handed out to the threads in order.
+
+enum sweep_class {
+	sweep_zero,
+	sweep_finite,
+	sweep_pos_inf,
+	sweep_neg_inf,
+	sweep_nan,
+};
+const char* sweep_class_names[] = { "0", "finite", "inf", "-inf", "nan" };
+
+enum sweep_input {
+	input_pos_zero,
+	input_neg_zero,
+	input_pos_inf,
+	input_nan,
+	input_negative, // Including -inf.
+	input_subnormal,
+	input_special_count,
+	input_normal = input_special_count,
+};
+const char* sweep_input_names[] = { "+0", "-0", "+Inf", "NaN", "Neg", "Denorm" };
+const sweep_class sweep_expected[] = { sweep_pos_inf, sweep_neg_inf, sweep_zero, sweep_nan, sweep_nan, sweep_finite };
+
+struct sweep_kernel {
+	const char* name;
+	void (*function)(float*); // SWEEP_BLOCK floats in place.
+};
+
+struct sweep_stats {
+	double max_ulp = 0;
+	double sum_ulp = 0;
+	double max_rel = 0;
+	double sum_rel = 0;
+	uint64_t count = 0;
+	uint32_t worst = 0; // Input with the largest error in ULP.
+	uint64_t special_total[input_special_count] = {};
+	uint64_t special_correct[input_special_count] = {};
+	sweep_class special_wrong[input_special_count] = {}; // What came out instead, for the last wrong result.
+};
+
+sweep_input sweep_classify_input(uint32_t bits) {
+	uint32_t exponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+	if (bits == 0x00000000)
+		return input_pos_zero;
+	if (bits == 0x80000000)
+		return input_neg_zero;
+	if (bits == 0x7F800000)
+		return input_pos_inf;
+	if (exponent == 0xFF && mantissa != 0)
+		return input_nan;
+	if (bits & 0x80000000)
+		return input_negative;
+	if (exponent == 0)
+		return input_subnormal;
+	return input_normal;
+}
+
+sweep_class sweep_classify_result(float v) {
+	if (std::isnan(v))
+		return sweep_nan;
+	if (std::isinf(v))
+		return v > 0 ? sweep_pos_inf : sweep_neg_inf;
+	if (v == 0)
+		return sweep_zero;
+	return sweep_finite;
+}
+
+void sweep_thread(const std::vector<sweep_kernel>& kernels, std::vector<sweep_stats>& stats, std::atomic<uint64_t>& next) {
+	std::vector<float> input(SWEEP_BLOCK), output(SWEEP_BLOCK);
+	std::vector<double> reference(SWEEP_BLOCK), ulp(SWEEP_BLOCK);
+	std::vector<sweep_input> type(SWEEP_BLOCK);
+
+	for (uint64_t chunk = next.fetch_add(SWEEP_CHUNK); chunk < (1ull << 32); chunk = next.fetch_add(SWEEP_CHUNK)) {
+		for (uint64_t block = chunk; block < chunk + SWEEP_CHUNK; block += SWEEP_BLOCK) {
+			// The reference is shared by all kernels, only computed once per block.
+			for (size_t n = 0; n < SWEEP_BLOCK; n++) {
+				uint32_t bits = uint32_t(block + n);
+				memcpy(&input[n], &bits, sizeof(float));
+				type[n] = sweep_classify_input(bits);
+				if (type[n] == input_normal) {
+					reference[n] = 1.0 / std::sqrt(double(input[n]));
+
+					// One unit in the last place of a float of the same binade as the reference.
+					uint64_t rbits;
+					memcpy(&rbits, &reference[n], sizeof(double));
+					int64_t exponent = int64_t((rbits >> 52) & 0x7FF) - 1023;
+					uint64_t ubits = uint64_t(std::max<int64_t>(exponent, -126) - 23 + 1023) << 52;
+					memcpy(&ulp[n], &ubits, sizeof(double));
+				}
+			}
+
+			for (size_t k = 0; k < kernels.size(); k++) {
+				output = input;
+				kernels[k].function(output.data());
+
+				sweep_stats& s = stats[k];
+				for (size_t n = 0; n < SWEEP_BLOCK; n++) {
+					if (type[n] == input_normal) {
+						double error = std::fabs(double(output[n]) - reference[n]);
+						if (!(error == error)) // NaN is as wrong as it gets.
+							error = std::numeric_limits<double>::infinity();
+						double ulps = error / ulp[n];
+						double rel = error / reference[n];
+						if (ulps > s.max_ulp) {
+							s.max_ulp = ulps;
+							s.worst = uint32_t(block + n);
+						}
+						s.max_rel = std::max(s.max_rel, rel);
+						s.sum_ulp += ulps;
+						s.sum_rel += rel;
+						s.count++;
+					} else {
+						sweep_class result = sweep_classify_result(output[n]);
+						s.special_total[type[n]]++;
+						if (result == sweep_expected[type[n]]) {
+							s.special_correct[type[n]]++;
+						} else {
+							s.special_wrong[type[n]] = result;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+void sweep(const std::vector<sweep_kernel>& kernels, std::ofstream& csvfile) {
+	size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	printLog("Accuracy over all 2^32 inputs on %zu threads, error over the positive normal inputs...", threads);
+
+	auto t_start = std::chrono::high_resolution_clock::now();
+	std::atomic<uint64_t> next(0);
+	std::vector<std::vector<sweep_stats>> partial(threads, std::vector<sweep_stats>(kernels.size()));
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < threads; t++) {
+		workers.emplace_back(sweep_thread, std::cref(kernels), std::ref(partial[t]), std::ref(next));
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	auto t_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - t_start);
+
+	csvfile << "\"Test\",\"Max ULP\",\"Mean ULP\",\"Max Rel.\",\"Mean Rel.\",\"Worst Input\"";
+	for (size_t c = 0; c < input_special_count; c++) {
+		csvfile << ",\"" << sweep_input_names[c] << " Correct\",\"" << sweep_input_names[c] << " Total\"";
+	}
+	csvfile << std::endl;
+
+	// Special inputs are "ok" if every result is what IEEE 754 gives, otherwise what came out instead for single
+	// inputs, or the share of correct results for ranges.
+	printLog("| Test Name                      | Max ULP      | Mean ULP   | Max Rel.   | Mean Rel.  | +0     | -0     | +Inf   | NaN    | Neg    | Denorm |");
+	printLog("|:-------------------------------|-------------:|-----------:|-----------:|-----------:|-------:|-------:|-------:|-------:|-------:|-------:|");
+	for (size_t k = 0; k < kernels.size(); k++) {
+		sweep_stats s;
+		for (size_t t = 0; t < threads; t++) {
+			const sweep_stats& p = partial[t][k];
+			if (p.max_ulp > s.max_ulp) {
+				s.max_ulp = p.max_ulp;
+				s.worst = p.worst;
+			}
+			s.max_rel = std::max(s.max_rel, p.max_rel);
+			s.sum_ulp += p.sum_ulp;
+			s.sum_rel += p.sum_rel;
+			s.count += p.count;
+			for (size_t c = 0; c < input_special_count; c++) {
+				s.special_total[c] += p.special_total[c];
+				s.special_correct[c] += p.special_correct[c];
+				if (p.special_correct[c] != p.special_total[c])
+					s.special_wrong[c] = p.special_wrong[c];
+			}
+		}
+
+		char special[input_special_count][16];
+		for (size_t c = 0; c < input_special_count; c++) {
+			if (s.special_correct[c] == s.special_total[c]) {
+				snprintf(special[c], sizeof(special[c]), "ok");
+			} else if (s.special_total[c] == 1) {
+				snprintf(special[c], sizeof(special[c]), "%s", sweep_class_names[s.special_wrong[c]]);
+			} else {
+				snprintf(special[c], sizeof(special[c]), "%.1f%%", 100.0 * double(s.special_correct[c]) / double(s.special_total[c]));
+			}
+		}
+
+		double mean_ulp = s.sum_ulp / double(s.count);
+		double mean_rel = s.sum_rel / double(s.count);
+		printLog("| %-30s | %12.3f | %10.4f | %10.3e | %10.3e | %6s | %6s | %6s | %6s | %6s | %6s |",
+				 kernels[k].name, s.max_ulp, mean_ulp, s.max_rel, mean_rel,
+				 special[0], special[1], special[2], special[3], special[4], special[5]);
+		if (csvfile.good()) {
+			csvfile
+				<< '"' << kernels[k].name << '"' << ','
+				<< s.max_ulp << ','
+				<< mean_ulp << ','
+				<< s.max_rel << ','
+				<< mean_rel << ','
+				<< s.worst;
+			for (size_t c = 0; c < input_special_count; c++) {
+				csvfile << ',' << s.special_correct[c] << ',' << s.special_total[c];
+			}
+			csvfile << std::endl;
+		}
+	}
+	printLog("|:-------------------------------|-------------:|-----------:|-----------:|-----------:|-------:|-------:|-------:|-------:|-------:|-------:|");
+	printLog("Sweep took %.1f s.", double(t_time.count()) / 1000.0);
+}
+
 int main(int argc, const char** argv) {
 	float testValue = 1234.56789f;
 	size_t testSize = 100000000;
@@ -431,8 +654,96 @@ int main(int argc, const char** argv) {
 	TESTMULTI("Q3 InvSqrt SSE (512 Ops)", invsqrt_q3_sse512, 512);
 	printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
 
+	// Only run what this CPU can execute, the other kernels would crash with an illegal instruction.
+	auto features = sandbox::cpuid_features();
+	if (features.avx2 && features.fma) {
+		TESTMULTI("RSqrt AVX2 (8 Ops)", (invsqrt_repeat<invsqrt_rsqrt_avx2, 8, 8>), 8);
+		TESTMULTI("RSqrt AVX2 (16 Ops)", (invsqrt_repeat<invsqrt_rsqrt_avx2, 8, 16>), 16);
+		TESTMULTI("RSqrt AVX2 (32 Ops)", (invsqrt_repeat<invsqrt_rsqrt_avx2, 8, 32>), 32);
+		TESTMULTI("RSqrt AVX2 (64 Ops)", (invsqrt_repeat<invsqrt_rsqrt_avx2, 8, 64>), 64);
+		TESTMULTI("RSqrt AVX2 (128 Ops)", (invsqrt_repeat<invsqrt_rsqrt_avx2, 8, 128>), 128);
+		TESTMULTI("RSqrt AVX2 (256 Ops)", (invsqrt_repeat<invsqrt_rsqrt_avx2, 8, 256>), 256);
+		TESTMULTI("RSqrt AVX2 (512 Ops)", (invsqrt_repeat<invsqrt_rsqrt_avx2, 8, 512>), 512);
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+		TESTMULTI("RSqrt AVX2 NR1 (8 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr1_avx2, 8, 8>), 8);
+		TESTMULTI("RSqrt AVX2 NR1 (16 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr1_avx2, 8, 16>), 16);
+		TESTMULTI("RSqrt AVX2 NR1 (32 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr1_avx2, 8, 32>), 32);
+		TESTMULTI("RSqrt AVX2 NR1 (64 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr1_avx2, 8, 64>), 64);
+		TESTMULTI("RSqrt AVX2 NR1 (128 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr1_avx2, 8, 128>), 128);
+		TESTMULTI("RSqrt AVX2 NR1 (256 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr1_avx2, 8, 256>), 256);
+		TESTMULTI("RSqrt AVX2 NR1 (512 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr1_avx2, 8, 512>), 512);
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+		TESTMULTI("RSqrt AVX2 NR2 (8 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr2_avx2, 8, 8>), 8);
+		TESTMULTI("RSqrt AVX2 NR2 (16 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr2_avx2, 8, 16>), 16);
+		TESTMULTI("RSqrt AVX2 NR2 (32 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr2_avx2, 8, 32>), 32);
+		TESTMULTI("RSqrt AVX2 NR2 (64 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr2_avx2, 8, 64>), 64);
+		TESTMULTI("RSqrt AVX2 NR2 (128 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr2_avx2, 8, 128>), 128);
+		TESTMULTI("RSqrt AVX2 NR2 (256 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr2_avx2, 8, 256>), 256);
+		TESTMULTI("RSqrt AVX2 NR2 (512 Ops)", (invsqrt_repeat<invsqrt_rsqrt_nr2_avx2, 8, 512>), 512);
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+	} else {
+		printLog("| %-30s | %-18s | %13s | %14s |", "RSqrt AVX2", "not supported", "", "");
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+	}
+	if (features.avx512f) {
+		TESTMULTI("RSqrt14 AVX-512 (16 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 16, 16>), 16);
+		TESTMULTI("RSqrt14 AVX-512 (32 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 16, 32>), 32);
+		TESTMULTI("RSqrt14 AVX-512 (64 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 16, 64>), 64);
+		TESTMULTI("RSqrt14 AVX-512 (128 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 16, 128>), 128);
+		TESTMULTI("RSqrt14 AVX-512 (256 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 16, 256>), 256);
+		TESTMULTI("RSqrt14 AVX-512 (512 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_avx512, 16, 512>), 512);
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+		TESTMULTI("RSqrt14 AVX-512 NR1 (16 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 16, 16>), 16);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (32 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 16, 32>), 32);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (64 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 16, 64>), 64);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (128 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 16, 128>), 128);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (256 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 16, 256>), 256);
+		TESTMULTI("RSqrt14 AVX-512 NR1 (512 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 16, 512>), 512);
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+		TESTMULTI("RSqrt14 AVX-512 NR2 (16 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 16, 16>), 16);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (32 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 16, 32>), 32);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (64 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 16, 64>), 64);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (128 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 16, 128>), 128);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (256 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 16, 256>), 256);
+		TESTMULTI("RSqrt14 AVX-512 NR2 (512 Ops)", (invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 16, 512>), 512);
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+	} else {
+		printLog("| %-30s | %-18s | %13s | %14s |", "RSqrt14 AVX-512", "not supported", "", "");
+		printLog("|:-------------------------------|-------------------:|--------------:|---------------:|");
+	}
+
 	csvfile.close();
 
+	// Accuracy of every kernel, both Quake III constants side by side for the widest one.
+	std::vector<sweep_kernel> kernels = {
+		{ "InvSqrt", invsqrt512 },
+		{ "InvSqrt SSE (1 Op)", invsqrt_repeat<invsqrt_single<invsqrt_sse>, 1, SWEEP_BLOCK> },
+		{ "InvSqrt SSE (2 Ops)", invsqrt_repeat<invsqrt_sse2, 2, SWEEP_BLOCK> },
+		{ "InvSqrt SSE", invsqrt_sse512 },
+		{ "Q3 InvSqrt", invsqrt_q3512 },
+		{ "Q3 InvSqrt SSE (1 Op)", invsqrt_repeat<invsqrt_single<invsqrt_q3_sse>, 1, SWEEP_BLOCK> },
+		{ "Q3 InvSqrt SSE (2 Ops)", invsqrt_repeat<invsqrt_q3_sse2, 2, SWEEP_BLOCK> },
+		{ "Q3 InvSqrt SSE (Carmack)", invsqrt_repeat<invsqrt_q3_sse4_with<CARMACK_CONSTANT>, 4, SWEEP_BLOCK> },
+		{ "Q3 InvSqrt SSE (Lomont)", invsqrt_repeat<invsqrt_q3_sse4_with<LOMONT_CONSTANT>, 4, SWEEP_BLOCK> },
+	};
+	if (features.avx2 && features.fma) {
+		kernels.push_back({ "RSqrt AVX2", invsqrt_repeat<invsqrt_rsqrt_avx2, 8, SWEEP_BLOCK> });
+		kernels.push_back({ "RSqrt AVX2 NR1", invsqrt_repeat<invsqrt_rsqrt_nr1_avx2, 8, SWEEP_BLOCK> });
+		kernels.push_back({ "RSqrt AVX2 NR2", invsqrt_repeat<invsqrt_rsqrt_nr2_avx2, 8, SWEEP_BLOCK> });
+	}
+	if (features.avx512f) {
+		kernels.push_back({ "RSqrt14 AVX-512", invsqrt_repeat<invsqrt_rsqrt14_avx512, 16, SWEEP_BLOCK> });
+		kernels.push_back({ "RSqrt14 AVX-512 NR1", invsqrt_repeat<invsqrt_rsqrt14_nr1_avx512, 16, SWEEP_BLOCK> });
+		kernels.push_back({ "RSqrt14 AVX-512 NR2", invsqrt_repeat<invsqrt_rsqrt14_nr2_avx512, 16, SWEEP_BLOCK> });
+	}
+
+	sprintf_s(buf.data(), 1024, "%.*s.accuracy.csv", strlen(argv[0]) - 4, argv[0]);
+	std::ofstream accuracyfile(buf.data(), std::ofstream::out);
+	if (accuracyfile.bad() | accuracyfile.fail())
+		printLog("CSV file can't be written to %s.", buf.data());
+	sweep(kernels, accuracyfile);
+	accuracyfile.close();
+
 	#ifdef _WIN32
 	timeEndPeriod(1);
 	#endif
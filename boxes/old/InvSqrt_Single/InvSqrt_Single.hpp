@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+
+// Hardware approximation of 1/sqrt(v) with 0, 1 or 2 Newton-Raphson steps, 8 floats at a time.
+// Needs AVX2 and FMA, see InvSqrt_Single_AVX2.cpp.
+void invsqrt_rsqrt_avx2(float* v);
+void invsqrt_rsqrt_nr1_avx2(float* v);
+void invsqrt_rsqrt_nr2_avx2(float* v);
+
+// Same with the 14 bit approximation of AVX-512, 16 floats at a time.
+// Needs AVX-512F, see InvSqrt_Single_AVX512.cpp.
+void invsqrt_rsqrt14_avx512(float* v);
+void invsqrt_rsqrt14_nr1_avx512(float* v);
+void invsqrt_rsqrt14_nr2_avx512(float* v);
+
+// Calls a kernel of the given width until Count floats are done.
+template<void (*Function)(float*), size_t Width, size_t Count>
+void invsqrt_repeat(float* v) {
+	for (size_t n = 0; n < Count; n += Width) {
+		Function(v + n);
+	}
+}
+
+// Turns a kernel for a single float into one that works in place, for invsqrt_repeat.
+template<float (*Function)(float)>
+void invsqrt_single(float* v) {
+	v[0] = Function(v[0]);
+}
@@ -0,0 +1,31 @@
+#include <immintrin.h>
+#include "InvSqrt_Single.hpp"
+
+// Compiled with AVX2 and FMA enabled, only call these if CPUID reports both.
+
+// _mm256_rsqrt_ps is good for about 12 bits. Every Newton-Raphson step
+//   y = y * (1.5 - 0.5 * v * y * y)
+// roughly doubles that, so two steps get to the full 24 bits of a float.
+template<size_t Steps>
+static inline __m256 rsqrt_avx2(__m256 value) {
+	const __m256 zero_point_five = _mm256_set1_ps(0.5f);
+	const __m256 one_point_five = _mm256_set1_ps(1.5f);
+
+	__m256 result = _mm256_rsqrt_ps(value);
+	__m256 halfvalue = _mm256_mul_ps(value, zero_point_five);
+	for (size_t step = 0; step < Steps; step++) {
+		__m256 correction = _mm256_fnmadd_ps(_mm256_mul_ps(halfvalue, result), result, one_point_five); // 1.5 - (x2 * y * y)
+		result = _mm256_mul_ps(result, correction);
+	}
+	return result;
+}
+
+void invsqrt_rsqrt_avx2(float* v) {
+	_mm256_storeu_ps(v, rsqrt_avx2<0>(_mm256_loadu_ps(v)));
+}
+void invsqrt_rsqrt_nr1_avx2(float* v) {
+	_mm256_storeu_ps(v, rsqrt_avx2<1>(_mm256_loadu_ps(v)));
+}
+void invsqrt_rsqrt_nr2_avx2(float* v) {
+	_mm256_storeu_ps(v, rsqrt_avx2<2>(_mm256_loadu_ps(v)));
+}
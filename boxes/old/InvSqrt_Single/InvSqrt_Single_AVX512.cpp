@@ -0,0 +1,31 @@
+#include <immintrin.h>
+#include "InvSqrt_Single.hpp"
+
+// Compiled with AVX-512F enabled, only call these if CPUID reports it.
+
+// _mm512_rsqrt14_ps is good for 14 bits, so one Newton-Raphson step already
+// gets to a few units in the last place of a float, and the second step only
+// reduces the rounding error of the first.
+template<size_t Steps>
+static inline __m512 rsqrt14_avx512(__m512 value) {
+	const __m512 zero_point_five = _mm512_set1_ps(0.5f);
+	const __m512 one_point_five = _mm512_set1_ps(1.5f);
+
+	__m512 result = _mm512_rsqrt14_ps(value);
+	__m512 halfvalue = _mm512_mul_ps(value, zero_point_five);
+	for (size_t step = 0; step < Steps; step++) {
+		__m512 correction = _mm512_fnmadd_ps(_mm512_mul_ps(halfvalue, result), result, one_point_five); // 1.5 - (x2 * y * y)
+		result = _mm512_mul_ps(result, correction);
+	}
+	return result;
+}
+
+void invsqrt_rsqrt14_avx512(float* v) {
+	_mm512_storeu_ps(v, rsqrt14_avx512<0>(_mm512_loadu_ps(v)));
+}
+void invsqrt_rsqrt14_nr1_avx512(float* v) {
+	_mm512_storeu_ps(v, rsqrt14_avx512<1>(_mm512_loadu_ps(v)));
+}
+void invsqrt_rsqrt14_nr2_avx512(float* v) {
+	_mm512_storeu_ps(v, rsqrt14_avx512<2>(_mm512_loadu_ps(v)));
+}
@@ -13,13 +13,17 @@
 #include <unordered_map>
 #include <vector>
 #include <intrin.h>
+#include <sandbox/sampling.hpp>
 #include "apex_memmove.h"
 #include "measurer.hpp"
 #include "memcpy_adv.h"
 
 #undef max
 
-#define MEASURE_TEST_CYCLES 1000
+// Copies per function and size, until the median is known to within MEASURE_TARGET.
+#define MEASURE_MIN_SAMPLES 100
+#define MEASURE_MAX_SAMPLES 1000
+#define MEASURE_TARGET 0.01
 
 #define SIZE(W, H, C, N) \
 	{ \
@@ -217,15 +221,23 @@ int32_t main(int32_t argc, const char* argv[])
 
 	measurer fence, fenc2, flush;
 
+	sandbox::sampling_options sampling;
+	sampling.statistic   = sandbox::sampling_statistic::median;
+	sampling.target      = MEASURE_TARGET;
+	sampling.min_samples = MEASURE_MIN_SAMPLES;
+	sampling.max_samples = MEASURE_MAX_SAMPLES;
+	sampling.interval    = MEASURE_MIN_SAMPLES;
+
 	std::cin.get();
 	for (auto test : test_sizes) {
 		std::cout << "Testing '" << test.second << "' ( " << (test.first) << " B )..." << std::endl;
-		std::cout << "Name            | Avg.  MB/s | 95.0% MB/s | 99.0% MB/s | 99.9% MB/s " << std::endl
-		          << "----------------+------------+------------+------------+------------" << std::endl;
+		std::cout << "Name            | Avg.  MB/s | 95.0% MB/s | 99.0% MB/s | 99.9% MB/s | CI width | Samples" << std::endl
+		          << "----------------+------------+------------+------------+------------+----------+--------" << std::endl;
 
 		size_t size = test.first;
 		for (auto func : functions) {
-			measurer measure;
+			measurer         measure;
+			sandbox::sampler sampler(sampling);
 
 			auto inits = initializers.find(func.first);
 			if (inits != initializers.end()) {
@@ -235,7 +247,7 @@ int32_t main(int32_t argc, const char* argv[])
 			std::cout << setw(16) << setiosflags(ios::left) << func.first;
 			std::cout << setw(0) << resetiosflags(ios::left) << "|" << std::flush;
 
-			for (size_t idx = 0; idx < MEASURE_TEST_CYCLES; idx++) {
+			while (!sampler.done()) {
 				// Get a random address to work from, but don't drop the 32-byte alignment.
 				uint8_t* from = buf_from.data() + ((rand() % largest_size * 3) & ~0b011111);
 				uint8_t* to   = buf_to.data() + ((rand() % largest_size * 3) & ~0b011111);
@@ -257,8 +269,12 @@ int32_t main(int32_t argc, const char* argv[])
 				}
 
 				{
-					auto tracker = measure.track();
+					auto start = std::chrono::high_resolution_clock::now();
 					func.second(to, from, size);
+					auto end      = std::chrono::high_resolution_clock::now();
+					auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+					measure.track(duration);
+					sampler.add(duration.count());
 				}
 
 				// Fence to avoid any incorrect late load/stores that can affect timings.
@@ -272,7 +288,7 @@ int32_t main(int32_t argc, const char* argv[])
 				//_mm_mfence();
 
 				// Clear Insutruction Caches and likely have an impact on branch caches.
-				for (size_t idx2 = 0; idx < 100; idx++) {
+				for (size_t idx2 = 0; idx2 < 100; idx2++) {
 					rw1 += rw2;
 					rw2 -= rw3 * rw7;
 					rw8 = rw2 - rw1;
@@ -309,7 +325,10 @@ int32_t main(int32_t argc, const char* argv[])
 			std::cout << setw(11) << setprecision(2) << setiosflags(ios::right) << std::fixed << kbyte_990
 			          << setw(0) << resetiosflags(ios::right) << " |" << std::flush;
 			std::cout << setw(11) << setprecision(2) << setiosflags(ios::right) << std::fixed << kbyte_999
-			          << setw(0) << resetiosflags(ios::right);
+			          << setw(0) << resetiosflags(ios::right) << " |" << std::flush;
+			std::cout << setw(8) << setprecision(2) << setiosflags(ios::right) << std::fixed
+			          << (sampler.precision() * 100.0) << "% " << setw(0) << resetiosflags(ios::right) << "|" << setw(8)
+			          << setiosflags(ios::right) << sampler.count() << setw(0) << resetiosflags(ios::right);
 
 			std::cout << std::defaultfloat << std::endl;
 		}
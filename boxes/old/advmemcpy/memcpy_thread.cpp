@@ -1,5 +1,5 @@
 #include "memcpy_adv.h"
-#include "os.hpp"
+#include <sandbox/pool.hpp>
 
 #include <array>
 #include <iostream>
@@ -27,12 +27,12 @@ void* memcpy_movsb(unsigned char* to, unsigned char* from, size_t size)
 }
 
 struct memcpy_task {
-	void*          from       = nullptr;
-	void*          to         = nullptr;
-	size_t         size       = 0;
-	os::Semaphore* semaphore  = nullptr;
-	size_t         index      = 0;
-	size_t         block_size = 0;
+	void*               from       = nullptr;
+	void*               to         = nullptr;
+	size_t              size       = 0;
+	sandbox::semaphore* semaphore  = nullptr;
+	size_t              index      = 0;
+	size_t              block_size = 0;
 #ifndef BLOCK_BASED
 	size_t block_size_rem = 0;
 #endif
@@ -40,7 +40,7 @@ struct memcpy_task {
 
 struct memcpy_env {
 	void* (*copyfnc)(void*, void*, size_t);
-	os::Semaphore            semaphore;
+	sandbox::semaphore       semaphore;
 	std::mutex               queue_mutex;
 	std::queue<memcpy_task>  task_queue;
 	size_t                   block_size   = BLOCK_SIZE;
@@ -53,9 +53,9 @@ static void* (*memcpy_fnc)(void*, const void*, size_t) = &memcpy;
 
 static void memcpy_thread_main(memcpy_env* env)
 {
-	os::Semaphore* semaphore;
-	void *         from, *to;
-	size_t         size;
+	sandbox::semaphore* semaphore;
+	void *              from, *to;
+	size_t              size;
 	do {
 		env->semaphore.wait();
 		{
@@ -121,7 +121,7 @@ void memcpy_thread_env(void* env)
 
 void* memcpy_thread(void* to, void* from, size_t size)
 {
-	os::Semaphore semaphore;
+	sandbox::semaphore semaphore;
 
 	memcpy_task task;
 	task.from      = from;
@@ -0,0 +1,92 @@
+#include "cpuid.hpp"
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+sandbox::cpuid_result sandbox::cpuid(uint32_t leaf, uint32_t subleaf)
+{
+	cpuid_result result = {0, 0, 0, 0};
+#ifdef _MSC_VER
+	int regs[4];
+	__cpuidex(regs, int(leaf), int(subleaf));
+	result.eax = uint32_t(regs[0]);
+	result.ebx = uint32_t(regs[1]);
+	result.ecx = uint32_t(regs[2]);
+	result.edx = uint32_t(regs[3]);
+#else
+	__cpuid_count(leaf, subleaf, result.eax, result.ebx, result.ecx, result.edx);
+#endif
+	return result;
+}
+
+std::string sandbox::cpuid_brand()
+{
+	// The brand string is spread across three extended leaves.
+	if (cpuid(0x80000000).eax < 0x80000004) {
+		return "Unknown";
+	}
+
+	char brand[49] = {0};
+	for (uint32_t leaf = 0; leaf < 3; leaf++) {
+		cpuid_result result = cpuid(0x80000002 + leaf);
+		memcpy(brand + leaf * 16 + 0, &result.eax, 4);
+		memcpy(brand + leaf * 16 + 4, &result.ebx, 4);
+		memcpy(brand + leaf * 16 + 8, &result.ecx, 4);
+		memcpy(brand + leaf * 16 + 12, &result.edx, 4);
+	}
+
+	// Some processors pad the front with spaces.
+	std::string value = brand;
+	value.erase(0, value.find_first_not_of(' '));
+	return value;
+}
+
+static uint64_t xgetbv(uint32_t index)
+{
+#ifdef _MSC_VER
+	return _xgetbv(index);
+#else
+	uint32_t eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+	return (uint64_t(edx) << 32) | eax;
+#endif
+}
+
+sandbox::cpuid_flags sandbox::cpuid_features()
+{
+	cpuid_flags flags = {};
+
+	uint32_t     max_leaf = cpuid(0).eax;
+	cpuid_result leaf1    = cpuid(1);
+	cpuid_result leaf7    = (max_leaf >= 7) ? cpuid(7) : cpuid_result{0, 0, 0, 0};
+	cpuid_result leaf7_1  = ((max_leaf >= 7) && (leaf7.eax >= 1)) ? cpuid(7, 1) : cpuid_result{0, 0, 0, 0};
+	cpuid_result extended = (cpuid(0x80000000).eax >= 0x80000001) ? cpuid(0x80000001) : cpuid_result{0, 0, 0, 0};
+
+	// The OS has to save the wider registers on context switches, which it reports in XCR0.
+	bool     osxsave   = (leaf1.ecx & (1u << 27)) != 0;
+	uint64_t xcr0      = osxsave ? xgetbv(0) : 0;
+	bool     os_avx    = (xcr0 & 0x06) == 0x06; // XMM and YMM state.
+	bool     os_avx512 = (xcr0 & 0xE6) == 0xE6; // Also the opmask and ZMM state.
+
+	flags.sse2    = (leaf1.edx & (1u << 26)) != 0;
+	flags.popcnt  = (leaf1.ecx & (1u << 23)) != 0;
+	flags.lzcnt   = (extended.ecx & (1u << 5)) != 0; // ABM on AMD, LZCNT on Intel.
+	flags.bmi1    = (leaf7.ebx & (1u << 3)) != 0;
+	flags.bmi2    = (leaf7.ebx & (1u << 8)) != 0;
+	flags.avx     = os_avx && ((leaf1.ecx & (1u << 28)) != 0);
+	flags.fma     = flags.avx && ((leaf1.ecx & (1u << 12)) != 0);
+	flags.avx2    = flags.avx && ((leaf7.ebx & (1u << 5)) != 0);
+	flags.f16c    = flags.avx && ((leaf1.ecx & (1u << 29)) != 0);
+	flags.avx512f = os_avx512 && ((leaf7.ebx & (1u << 16)) != 0);
+
+	// Everything else in AVX-512 builds on the foundation.
+	flags.avx512bw   = flags.avx512f && ((leaf7.ebx & (1u << 30)) != 0);
+	flags.avx512fp16 = flags.avx512bw && ((leaf7.edx & (1u << 23)) != 0);
+	flags.avx512bf16 = flags.avx512f && ((leaf7_1.eax & (1u << 5)) != 0);
+	return flags;
+}
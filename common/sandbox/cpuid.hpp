@@ -0,0 +1,37 @@
+#pragma once
+#include <cinttypes>
+#include <string>
+
+namespace sandbox {
+	struct cpuid_result {
+		uint32_t eax;
+		uint32_t ebx;
+		uint32_t ecx;
+		uint32_t edx;
+	};
+
+	// Execute CPUID with the given leaf and sub-leaf.
+	cpuid_result cpuid(uint32_t leaf, uint32_t subleaf = 0);
+
+	// Processor brand string, e.g. "AMD Ryzen 9 5950X 16-Core Processor".
+	std::string cpuid_brand();
+
+	// Instruction set extensions that are usable, which needs both the CPU and the OS to support them.
+	struct cpuid_flags {
+		bool sse2;
+		bool popcnt;
+		bool lzcnt;
+		bool bmi1;
+		bool bmi2;
+		bool avx;
+		bool avx2;
+		bool fma;
+		bool f16c;
+		bool avx512f;
+		bool avx512bw;
+		bool avx512fp16;
+		bool avx512bf16;
+	};
+
+	cpuid_flags cpuid_features();
+} // namespace sandbox
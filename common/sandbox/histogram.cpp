@@ -0,0 +1,92 @@
+#include "histogram.hpp"
+#include <algorithm>
+#include <cmath>
+
+sandbox::histogram::histogram() : _count(0) {}
+
+sandbox::histogram::~histogram() {}
+
+void sandbox::histogram::track(uint64_t value, uint64_t count)
+{
+	_buckets[value] += count;
+	_count += count;
+}
+
+void sandbox::histogram::merge(const histogram& other)
+{
+	for (auto kv : other._buckets) {
+		track(kv.first, kv.second);
+	}
+}
+
+void sandbox::histogram::clear()
+{
+	_buckets.clear();
+	_count = 0;
+}
+
+const std::map<uint64_t, uint64_t>& sandbox::histogram::buckets() const
+{
+	return _buckets;
+}
+
+uint64_t sandbox::histogram::count() const
+{
+	return _count;
+}
+
+uint64_t sandbox::histogram::min() const
+{
+	return _buckets.empty() ? 0 : _buckets.begin()->first;
+}
+
+uint64_t sandbox::histogram::max() const
+{
+	return _buckets.empty() ? 0 : _buckets.rbegin()->first;
+}
+
+double sandbox::histogram::average() const
+{
+	if (_count == 0) {
+		return 0;
+	}
+
+	double sum = 0;
+	for (auto kv : _buckets) {
+		sum += double(kv.first) * double(kv.second);
+	}
+	return sum / double(_count);
+}
+
+double sandbox::histogram::variance() const
+{
+	if (_count < 2) {
+		return 0;
+	}
+
+	double mean = average();
+	double sum  = 0;
+	for (auto kv : _buckets) {
+		double delta = double(kv.first) - mean;
+		sum += delta * delta * double(kv.second);
+	}
+	return sum / double(_count - 1);
+}
+
+uint64_t sandbox::histogram::percentile(double fraction) const
+{
+	if (_count == 0) {
+		return 0;
+	}
+
+	// Nearest rank: the value at position ceil(fraction * count).
+	uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(fraction * double(_count))));
+	uint64_t seen = 0;
+	for (auto kv : _buckets) {
+		seen += kv.second;
+		if (seen >= rank) {
+			return kv.first;
+		}
+	}
+	return _buckets.rbegin()->first;
+}
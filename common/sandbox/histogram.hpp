@@ -0,0 +1,43 @@
+#pragma once
+#include <cinttypes>
+#include <map>
+
+namespace sandbox {
+	/* Histogram
+
+	Counts how often each exact value was seen. Values are kept exact rather than
+	binned, since the spread of latencies is usually narrow enough that the map
+	stays small, and exact values make merging and comparing runs trivial.
+	*/
+	class histogram {
+		std::map<uint64_t, uint64_t> _buckets;
+		uint64_t                     _count;
+
+		public:
+		histogram();
+
+		// Out of line, so translation units built for other instruction sets don't each emit their own copy.
+		~histogram();
+
+		void track(uint64_t value, uint64_t count = 1);
+
+		void merge(const histogram& other);
+
+		void clear();
+
+		const std::map<uint64_t, uint64_t>& buckets() const;
+
+		uint64_t count() const;
+
+		uint64_t min() const;
+
+		uint64_t max() const;
+
+		double average() const;
+
+		double variance() const;
+
+		// Smallest value that at least the given fraction (0..1) of all values are less than or equal to.
+		uint64_t percentile(double fraction) const;
+	};
+} // namespace sandbox
@@ -0,0 +1,43 @@
+#pragma once
+#include <type_traits>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* Optimization Barriers
+
+Benchmarks need the compiler to do the work exactly as written, without the
+cost of a volatile load and store on every step. These are empty inline assembly
+statements the compiler can not see into, so it has to keep what they touch.
+*/
+
+namespace sandbox {
+	// The compiler has to assume the value is read and changed here, and that any memory may have been read too.
+	// Unlike a volatile, the value stays in its register: integers in a general purpose one, everything else in an
+	// SSE/AVX one, so a chain through it costs no loads or stores.
+	template<typename _Ty1>
+	static inline void do_not_optimize(_Ty1& value)
+	{
+#ifdef _MSC_VER
+		// MSVC has no inline assembly on x64, so the value has to go through memory after all.
+		*static_cast<volatile char*>(static_cast<void*>(&value));
+		_ReadWriteBarrier();
+#else
+		if constexpr (std::is_integral<_Ty1>::value || std::is_pointer<_Ty1>::value) {
+			asm volatile("" : "+r"(value) : : "memory");
+		} else {
+			asm volatile("" : "+v"(value) : : "memory");
+		}
+#endif
+	}
+
+	// The compiler has to assume all memory was read and written here, so pending stores happen before it.
+	static inline void clobber_memory()
+	{
+#ifdef _MSC_VER
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : : "memory");
+#endif
+	}
+} // namespace sandbox
@@ -0,0 +1,97 @@
+#include "pool.hpp"
+
+sandbox::semaphore::semaphore(size_t count) : _count(count) {}
+
+void sandbox::semaphore::notify(size_t count)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_count += count;
+	if (count == 1) {
+		_condition.notify_one();
+	} else {
+		_condition.notify_all();
+	}
+}
+
+void sandbox::semaphore::wait(size_t count)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true) {
+		if (_count > 0) { // Another thread may have been faster.
+			_count--;
+			count--;
+			if (count == 0) {
+				return;
+			}
+		}
+		_condition.wait(lock, [this] { return (_count > 0); });
+	}
+}
+
+bool sandbox::semaphore::try_wait(size_t count)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	if (_count >= count) {
+		_count -= count;
+		return true;
+	}
+	return false;
+}
+
+bool sandbox::thread_task::work()
+{
+	return true;
+}
+
+sandbox::thread_pool::thread_pool(size_t threads)
+{
+	// A std::thread either runs or throws, so there is no start to wait for.
+	for (size_t n = 0; n < threads; n++) {
+		_threads.emplace_back(&thread_pool::worker, this);
+	}
+}
+
+sandbox::thread_pool::~thread_pool()
+{
+	// One stop marker per worker, behind every task that is already queued.
+	for (size_t n = 0; n < _threads.size(); n++) {
+		post_task(nullptr);
+	}
+	for (auto& thread : _threads) {
+		if (thread.joinable())
+			thread.join();
+	}
+}
+
+void sandbox::thread_pool::post_task(thread_task* task)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_queue.push(task);
+	_semaphore.notify();
+}
+
+void sandbox::thread_pool::post_tasks(thread_task* tasks[], size_t count)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	for (size_t n = 0; n < count; n++) {
+		_queue.push(tasks[n]);
+	}
+	_semaphore.notify(count);
+}
+
+sandbox::thread_task* sandbox::thread_pool::wait_task()
+{
+	_semaphore.wait();
+	std::unique_lock<std::mutex> lock(_mutex);
+	thread_task*                 task = _queue.front();
+	_queue.pop();
+	return task;
+}
+
+void sandbox::thread_pool::worker()
+{
+	while (thread_task* task = wait_task()) {
+		task->failed    = !task->work();
+		task->completed = true;
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace sandbox {
+	// Counting semaphore on a mutex and a condition variable.
+	class semaphore {
+		size_t                  _count;
+		std::mutex              _mutex;
+		std::condition_variable _condition;
+
+		public:
+		semaphore(size_t count = 0);
+
+		void notify(size_t count = 1);
+
+		void wait(size_t count = 1);
+
+		bool try_wait(size_t count = 1);
+	};
+
+	struct thread_task {
+		// Written by the worker after work() returns, so a task must stay alive until it is done.
+		bool completed = false;
+		bool failed    = false;
+
+		virtual ~thread_task() {}
+
+		virtual bool work();
+	};
+
+	/* Thread Pool
+
+	Workers sleep on a semaphore until a task is posted, and run tasks in the order
+	they were posted. Destroying the pool runs every task posted until then, and
+	joins the workers afterwards.
+	*/
+	class thread_pool {
+		std::vector<std::thread> _threads;
+		semaphore                _semaphore;
+		std::mutex               _mutex;
+		std::queue<thread_task*> _queue;
+
+		thread_task* wait_task();
+
+		void worker();
+
+		public:
+		thread_pool(size_t threads);
+
+		~thread_pool();
+
+		void post_task(thread_task* task);
+
+		void post_tasks(thread_task* tasks[], size_t count);
+	};
+} // namespace sandbox
@@ -0,0 +1,97 @@
+#include "sampling.hpp"
+#include <algorithm>
+#include <cmath>
+
+double sandbox::sampling_z(double confidence)
+{
+	// Abramowitz & Stegun 26.2.23, accurate to about 4.5e-4.
+	double p = (1.0 - std::clamp(confidence, 0.0, 0.999999)) / 2.0;
+	double t = std::sqrt(-2.0 * std::log(p));
+	return t - (2.515517 + 0.802853 * t + 0.010328 * t * t) / (1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+}
+
+sandbox::sampler::sampler(const sampling_options& options)
+	: _options(options), _count(0), _mean(0), _m2(0), _lower(0), _upper(0), _next_check(options.min_samples), _converged(false)
+{}
+
+sandbox::sampler::~sampler() {}
+
+void sandbox::sampler::add(uint64_t sample)
+{
+	_count++;
+	double delta = double(sample) - _mean;
+	_mean += delta / double(_count);
+	_m2 += delta * (double(sample) - _mean);
+
+	if (_options.statistic == sampling_statistic::median) {
+		_histogram.track(sample);
+	}
+}
+
+void sandbox::sampler::evaluate()
+{
+	double z = sampling_z(_options.confidence);
+	if (_options.statistic == sampling_statistic::mean) {
+		double error = (_count > 1) ? (z * std::sqrt(_m2 / double(_count - 1)) / std::sqrt(double(_count))) : 0;
+		_lower       = _mean - error;
+		_upper       = _mean + error;
+	} else {
+		// The ranks n/2 +- z*sqrt(n)/2 bound the median, whatever the distribution.
+		double n      = double(_count);
+		double spread = z * std::sqrt(n) / 2.0;
+		_lower        = double(_histogram.percentile(std::max(0.0, (n / 2.0 - spread) / n)));
+		_upper        = double(_histogram.percentile(std::min(1.0, (n / 2.0 + spread + 1.0) / n)));
+	}
+	_converged = (_count >= _options.min_samples) && (precision() <= _options.target);
+}
+
+bool sandbox::sampler::done()
+{
+	if (_count >= _next_check) {
+		evaluate();
+		_next_check = _count + std::max<uint64_t>(_options.interval, 1);
+	}
+	return _converged || (_count >= _options.max_samples);
+}
+
+bool sandbox::sampler::converged() const
+{
+	return _converged;
+}
+
+uint64_t sandbox::sampler::count() const
+{
+	return _count;
+}
+
+double sandbox::sampler::estimate() const
+{
+	if (_options.statistic == sampling_statistic::mean) {
+		return _mean;
+	}
+	return double(_histogram.percentile(0.5));
+}
+
+double sandbox::sampler::lower() const
+{
+	return _lower;
+}
+
+double sandbox::sampler::upper() const
+{
+	return _upper;
+}
+
+double sandbox::sampler::precision() const
+{
+	double value = estimate();
+	if (value == 0) {
+		return (_upper > _lower) ? INFINITY : 0;
+	}
+	return (_upper - _lower) / std::abs(value);
+}
+
+const sandbox::sampling_options& sandbox::sampler::options() const
+{
+	return _options;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cinttypes>
+
+#include "histogram.hpp"
+
+namespace sandbox {
+	enum class sampling_statistic {
+		mean,   // Normal approximation, cheap but sensitive to outliers.
+		median, // Distribution-free, from order statistics of all samples.
+	};
+
+	struct sampling_options {
+		sampling_statistic statistic   = sampling_statistic::median;
+		double             confidence  = 0.95; // Two-sided confidence level.
+		double             target      = 0.01; // Target width of the interval, relative to the estimate.
+		uint64_t           min_samples = 1000;
+		uint64_t           max_samples = 1000000;
+		uint64_t           interval    = 1000; // Only re-evaluate every this many samples.
+	};
+
+	/* Sampling Controller
+
+	Decides how many samples a measurement needs: keep adding samples until done()
+	says the confidence interval of the chosen statistic is narrower than the
+	target, or the maximum number of samples is reached. Quiet measurements stop
+	early, noisy ones run longer.
+	*/
+	class sampler {
+		sampling_options _options;
+		histogram        _histogram;
+
+		// Welford's running mean and variance.
+		uint64_t _count;
+		double   _mean;
+		double   _m2;
+
+		double   _lower;
+		double   _upper;
+		uint64_t _next_check;
+		bool     _converged;
+
+		void evaluate();
+
+		public:
+		sampler(const sampling_options& options = sampling_options());
+
+		// Out of line, for the same reason as the one of histogram.
+		~sampler();
+
+		void add(uint64_t sample);
+
+		// True once converged or out of samples.
+		bool done();
+
+		// True if the target was met, false if we ran out of samples first.
+		bool converged() const;
+
+		uint64_t count() const;
+
+		// The chosen statistic and its confidence interval.
+		double estimate() const;
+		double lower() const;
+		double upper() const;
+
+		// Width of the confidence interval relative to the estimate.
+		double precision() const;
+
+		const sampling_options& options() const;
+	};
+
+	// Two-sided z-score for the given confidence level, e.g. 1.96 for 0.95.
+	double sampling_z(double confidence);
+} // namespace sandbox
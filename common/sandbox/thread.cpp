@@ -0,0 +1,40 @@
+#include "thread.hpp"
+
+#ifdef WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+void sandbox::thread_affinity(uint16_t processor, uint8_t thread_index)
+{
+#ifdef WIN32
+	HANDLE         thread = GetCurrentThread();
+	GROUP_AFFINITY gaff   = {0};
+	gaff.Group            = processor;
+	gaff.Mask             = 0b1ull << thread_index;
+
+	PROCESSOR_NUMBER pn = {0};
+	pn.Group            = gaff.Group;
+	pn.Number           = thread_index;
+
+	SetThreadIdealProcessorEx(thread, &pn, nullptr);
+	SetThreadGroupAffinity(thread, &gaff, nullptr);
+#else
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	CPU_SET(size_t(processor) * 64 + thread_index, &cpuset);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#endif
+}
+
+void sandbox::thread_priority_rt()
+{
+#ifdef WIN32
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#else
+#endif
+}
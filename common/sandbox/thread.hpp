@@ -0,0 +1,10 @@
+#pragma once
+#include <cinttypes>
+
+namespace sandbox {
+	// Pin the calling thread to a single logical processor.
+	void thread_affinity(uint16_t processor, uint8_t thread_index);
+
+	// Raise the calling thread to the highest priority we can get.
+	void thread_priority_rt();
+} // namespace sandbox
@@ -0,0 +1,91 @@
+#include "timer.hpp"
+#include <chrono>
+#include <cstdio>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <intrin.h>
+#else
+#include <time.h>
+#include <x86intrin.h>
+#endif
+
+sandbox::timer_overhead sandbox::timer_calibrate(timer_clock clock)
+{
+	switch (clock) {
+	case timer_clock::rdtsc:
+		return timer_calibrate([]() { return __rdtsc(); });
+	case timer_clock::rdtscp:
+		return timer_calibrate([]() {
+			unsigned int aux;
+			return __rdtscp(&aux);
+		});
+	case timer_clock::lfence_rdtsc:
+		return timer_calibrate([]() {
+			_mm_lfence();
+			return __rdtsc();
+		});
+	case timer_clock::os: {
+#ifdef WIN32
+		// Counts at a fixed frequency, usually 10 MHz, so convert the result afterwards.
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		timer_overhead overhead = timer_calibrate([]() {
+			LARGE_INTEGER value;
+			QueryPerformanceCounter(&value);
+			return uint64_t(value.QuadPart);
+		});
+		overhead.min    = overhead.min * 1000000000ull / uint64_t(frequency.QuadPart);
+		overhead.median = overhead.median * 1000000000ull / uint64_t(frequency.QuadPart);
+		return overhead;
+#else
+		return timer_calibrate([]() {
+			timespec value;
+			clock_gettime(CLOCK_MONOTONIC, &value);
+			return uint64_t(value.tv_sec) * 1000000000ull + uint64_t(value.tv_nsec);
+		});
+#endif
+	}
+	case timer_clock::high_resolution:
+		return timer_calibrate([]() { return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count()); });
+	}
+	return {0, 0};
+}
+
+const char* sandbox::timer_clock_name(timer_clock clock)
+{
+	switch (clock) {
+	case timer_clock::rdtsc:
+		return "rdtsc";
+	case timer_clock::rdtscp:
+		return "rdtscp";
+	case timer_clock::lfence_rdtsc:
+		return "lfence+rdtsc";
+	case timer_clock::os:
+#ifdef WIN32
+		return "QueryPerformanceCounter";
+#else
+		return "clock_gettime";
+#endif
+	case timer_clock::high_resolution:
+		return "high_resolution_clock";
+	}
+	return "unknown";
+}
+
+bool sandbox::timer_clock_tsc(timer_clock clock)
+{
+	return (clock == timer_clock::rdtsc) || (clock == timer_clock::rdtscp) || (clock == timer_clock::lfence_rdtsc);
+}
+
+void sandbox::timer_print(double ns_per_tick)
+{
+	printf("Clock                   |   Floor   |  Median  \n");
+	printf("------------------------+-----------+-----------\n");
+	for (auto clock : {timer_clock::rdtsc, timer_clock::rdtscp, timer_clock::lfence_rdtsc, timer_clock::os, timer_clock::high_resolution}) {
+		timer_overhead overhead = timer_calibrate(clock);
+		double         scale    = timer_clock_tsc(clock) ? ns_per_tick : 1.0;
+		printf("%-24s|%8.2fns |%8.2fns\n", timer_clock_name(clock), double(overhead.min) * scale, double(overhead.median) * scale);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <algorithm>
+#include <cinttypes>
+#include <vector>
+
+#define TIMER_CALIBRATION_SAMPLES 100000
+
+namespace sandbox {
+	enum class timer_clock {
+		rdtsc,           // Plain rdtsc, can be reordered with the code around it.
+		rdtscp,          // Waits for all earlier instructions before reading.
+		lfence_rdtsc,    // lfence followed by rdtsc, same ordering as rdtscp on most CPUs.
+		os,              // clock_gettime(CLOCK_MONOTONIC), QueryPerformanceCounter on Windows.
+		high_resolution, // std::chrono::high_resolution_clock.
+	};
+
+	// Cost of an empty timed region, in ticks for the TSC clocks and nanoseconds otherwise.
+	struct timer_overhead {
+		uint64_t min;
+		uint64_t median;
+	};
+
+	/* Timer Calibration
+
+	Reading a clock is not free, and a region timed with two reads always includes
+	the cost of one of them. For short regions that floor is a large part of the
+	result, so measure it by timing nothing at all, many times over.
+
+	The minimum is the floor that can safely be subtracted from every sample. The
+	median shows how much it usually costs, which matters for throughput.
+	*/
+	template<typename T>
+	timer_overhead timer_calibrate(T now)
+	{
+		std::vector<uint64_t> samples(TIMER_CALIBRATION_SAMPLES);
+		for (auto& sample : samples) {
+			auto t0 = now();
+			auto t1 = now();
+			sample  = uint64_t(t1 - t0);
+		}
+
+		std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+		return {*std::min_element(samples.begin(), samples.end()), samples[samples.size() / 2]};
+	}
+
+	timer_overhead timer_calibrate(timer_clock clock);
+
+	const char* timer_clock_name(timer_clock clock);
+
+	// True if the clock counts TSC ticks rather than nanoseconds.
+	bool timer_clock_tsc(timer_clock clock);
+
+	// Remove the floor from a measured region, without wrapping around for regions faster than it.
+	static inline uint64_t timer_subtract(uint64_t elapsed, uint64_t floor)
+	{
+		return (elapsed > floor) ? (elapsed - floor) : 0;
+	}
+
+	// Calibrate every clock and print a table, with TSC ticks converted using the given rate.
+	void timer_print(double ns_per_tick);
+} // namespace sandbox
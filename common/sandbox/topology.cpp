@@ -0,0 +1,312 @@
+#include "topology.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <thread>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+#ifndef WIN32
+// Parse a Linux cpu list ("0-3,8,10-11") into the first listed processor.
+static bool read_cpu_list_first(const std::string& path, uint32_t& value)
+{
+	std::ifstream file(path);
+	std::string   line;
+	if (!file.good() || !std::getline(file, line) || line.empty()) {
+		return false;
+	}
+
+	value = uint32_t(strtoul(line.c_str(), nullptr, 10));
+	return true;
+}
+
+static bool read_value(const std::string& path, uint32_t& value)
+{
+	std::ifstream file(path);
+	if (!file.good()) {
+		return false;
+	}
+	file >> value;
+	return !file.fail();
+}
+#endif
+
+std::vector<sandbox::topology_processor> sandbox::topology_detect()
+{
+	uint32_t                                 max_core_id = std::thread::hardware_concurrency();
+	std::vector<sandbox::topology_processor> processors(max_core_id);
+
+	// Default to every processor being its own core in a single cache, package and node.
+	for (uint32_t idx = 0; idx < max_core_id; idx++) {
+		processors[idx].id      = idx;
+		processors[idx].core    = idx;
+		processors[idx].l3      = 0;
+		processors[idx].package = 0;
+		processors[idx].node    = 0;
+	}
+
+#ifdef WIN32
+	DWORD length = 0;
+	GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+	std::vector<uint8_t> buffer(length);
+	if (!GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length)) {
+		return processors;
+	}
+
+	auto apply = [&processors](const GROUP_AFFINITY& mask, uint32_t sandbox::topology_processor::*field, uint32_t value) {
+		for (uint32_t bit = 0; bit < 64; bit++) {
+			if ((mask.Mask & (KAFFINITY(1) << bit)) == 0) {
+				continue;
+			}
+			size_t id = size_t(mask.Group) * 64 + bit;
+			if (id < processors.size()) {
+				processors[id].*field = value;
+			}
+		}
+	};
+
+	uint32_t cores = 0, caches = 0, packages = 0;
+	for (size_t offset = 0; offset < length;) {
+		auto info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+		switch (info->Relationship) {
+		case RelationProcessorCore:
+			for (WORD group = 0; group < info->Processor.GroupCount; group++) {
+				apply(info->Processor.GroupMask[group], &sandbox::topology_processor::core, cores);
+			}
+			cores++;
+			break;
+		case RelationProcessorPackage:
+			for (WORD group = 0; group < info->Processor.GroupCount; group++) {
+				apply(info->Processor.GroupMask[group], &sandbox::topology_processor::package, packages);
+			}
+			packages++;
+			break;
+		case RelationNumaNode:
+			apply(info->NumaNode.GroupMask, &sandbox::topology_processor::node, info->NumaNode.NodeNumber);
+			break;
+		case RelationCache:
+			if (info->Cache.Level == 3) {
+				apply(info->Cache.GroupMask, &sandbox::topology_processor::l3, caches);
+				caches++;
+			}
+			break;
+		default:
+			break;
+		}
+		offset += info->Size;
+	}
+#else
+	for (uint32_t idx = 0; idx < max_core_id; idx++) {
+		std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(idx);
+
+		// The lowest sibling identifies the physical core.
+		read_cpu_list_first(base + "/topology/thread_siblings_list", processors[idx].core);
+		read_value(base + "/topology/physical_package_id", processors[idx].package);
+
+		// The node shows up as a "nodeN" link, and is missing entirely without NUMA support.
+		std::error_code ec;
+		for (auto& entry : std::filesystem::directory_iterator(base, ec)) {
+			std::string name = entry.path().filename().string();
+			if ((name.compare(0, 4, "node") == 0) && (name.size() > 4) && isdigit(static_cast<unsigned char>(name[4]))) {
+				processors[idx].node = uint32_t(strtoul(name.c_str() + 4, nullptr, 10));
+				break;
+			}
+		}
+
+		// Find the level 3 cache, its lowest sharing processor identifies the domain.
+		for (uint32_t cdx = 0;; cdx++) {
+			std::string cache = base + "/cache/index" + std::to_string(cdx);
+			uint32_t    level = 0;
+			if (!read_value(cache + "/level", level)) {
+				break;
+			}
+			if (level == 3) {
+				read_cpu_list_first(cache + "/shared_cpu_list", processors[idx].l3);
+				break;
+			}
+		}
+	}
+#endif
+
+	return processors;
+}
+
+std::vector<uint32_t> sandbox::topology_order(const std::vector<topology_processor>& topology, uint32_t origin, topology_policy policy, bool include_origin)
+{
+	std::vector<uint32_t> order;
+	if (include_origin) {
+		order.push_back(origin);
+	}
+
+	// Bucket by domain, with the origin's domain always first.
+	std::vector<std::pair<uint32_t, std::vector<uint32_t>>> domains;
+	domains.push_back({topology[origin].l3, {}});
+	for (auto& processor : topology) {
+		if (processor.id == origin) {
+			continue;
+		}
+		auto itr = std::find_if(domains.begin(), domains.end(), [&processor](auto& v) { return v.first == processor.l3; });
+		if (itr == domains.end()) {
+			domains.push_back({processor.l3, {}});
+			itr = domains.end() - 1;
+		}
+		itr->second.push_back(processor.id);
+	}
+
+	switch (policy) {
+	case topology_policy::local:
+		for (auto& domain : domains) {
+			order.insert(order.end(), domain.second.begin(), domain.second.end());
+		}
+		break;
+	case topology_policy::remote:
+		for (size_t n = 1; n < domains.size(); n++) {
+			order.insert(order.end(), domains[n].second.begin(), domains[n].second.end());
+		}
+		order.insert(order.end(), domains[0].second.begin(), domains[0].second.end());
+		break;
+	case topology_policy::spread:
+		for (size_t n = 0; order.size() < (topology.size() - (include_origin ? 0 : 1)); n++) {
+			for (auto& domain : domains) {
+				if (n < domain.second.size()) {
+					order.push_back(domain.second[n]);
+				}
+			}
+		}
+		break;
+	}
+
+	return order;
+}
+
+bool sandbox::topology_policy_parse(const char* name, topology_policy& policy)
+{
+	for (auto value : {topology_policy::local, topology_policy::remote, topology_policy::spread}) {
+		if (strcmp(name, topology_policy_name(value)) == 0) {
+			policy = value;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* sandbox::topology_policy_name(topology_policy policy)
+{
+	switch (policy) {
+	case topology_policy::local:
+		return "local";
+	case topology_policy::remote:
+		return "remote";
+	case topology_policy::spread:
+		return "spread";
+	}
+	return "unknown";
+}
+
+bool sandbox::topology_siblings(const std::vector<topology_processor>& topology, uint32_t a, uint32_t b)
+{
+	return (a != b) && (topology[a].core == topology[b].core);
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> sandbox::topology_pairs(const std::vector<topology_processor>& topology, topology_smt smt)
+{
+	// The first processor seen on every physical core represents it.
+	std::set<uint32_t> cores;
+	std::vector<bool>  primary(topology.size(), false);
+	for (auto& processor : topology) {
+		primary[processor.id] = cores.insert(processor.core).second;
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> pairs;
+	for (auto& reader : topology) {
+		for (auto& writer : topology) {
+			if (reader.id == writer.id) {
+				continue;
+			}
+
+			bool siblings = topology_siblings(topology, reader.id, writer.id);
+			switch (smt) {
+			case topology_smt::physical:
+				if (!primary[reader.id] || !primary[writer.id]) {
+					continue;
+				}
+				break;
+			case topology_smt::siblings:
+				if (!siblings) {
+					continue;
+				}
+				break;
+			case topology_smt::both:
+				break;
+			}
+			pairs.push_back({reader.id, writer.id});
+		}
+	}
+	return pairs;
+}
+
+std::vector<std::vector<std::pair<uint32_t, uint32_t>>> sandbox::topology_schedule(const std::vector<topology_processor>& topology, const std::vector<std::pair<uint32_t, uint32_t>>& pairs, size_t max_concurrent)
+{
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> rounds;
+	std::vector<bool>                                       scheduled(pairs.size(), false);
+
+	// Greedily fill each round with the earliest pairs whose physical cores are still free.
+	for (size_t remaining = pairs.size(); remaining > 0;) {
+		std::vector<std::pair<uint32_t, uint32_t>> round;
+		std::set<uint32_t>                         busy;
+		for (size_t n = 0; n < pairs.size(); n++) {
+			if (scheduled[n]) {
+				continue;
+			}
+			if ((max_concurrent != 0) && (round.size() >= max_concurrent)) {
+				break;
+			}
+
+			uint32_t reader = topology[pairs[n].first].core;
+			uint32_t writer = topology[pairs[n].second].core;
+			if ((busy.count(reader) != 0) || (busy.count(writer) != 0)) {
+				continue;
+			}
+
+			busy.insert(reader);
+			busy.insert(writer);
+			round.push_back(pairs[n]);
+			scheduled[n] = true;
+			remaining--;
+		}
+		rounds.push_back(round);
+	}
+	return rounds;
+}
+
+bool sandbox::topology_smt_parse(const char* name, topology_smt& smt)
+{
+	for (auto value : {topology_smt::physical, topology_smt::siblings, topology_smt::both}) {
+		if (strcmp(name, topology_smt_name(value)) == 0) {
+			smt = value;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* sandbox::topology_smt_name(topology_smt smt)
+{
+	switch (smt) {
+	case topology_smt::physical:
+		return "physical";
+	case topology_smt::siblings:
+		return "siblings";
+	case topology_smt::both:
+		return "both";
+	}
+	return "unknown";
+}
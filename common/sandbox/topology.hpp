@@ -0,0 +1,61 @@
+#pragma once
+#include <cinttypes>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/* Processor Topology
+
+Describes where each logical processor sits, so that modes can pick cores that
+share (or deliberately do not share) a physical core, a last level cache, a
+package or a NUMA node. Domain identifiers are only meaningful for comparison, they are not
+indices into anything.
+*/
+
+namespace sandbox {
+	struct topology_processor {
+		uint32_t id;      // Logical processor index, as used by thread_affinity.
+		uint32_t core;    // Physical core, shared by SMT siblings.
+		uint32_t l3;      // Last level cache domain.
+		uint32_t package; // Physical package/socket.
+		uint32_t node;    // NUMA node.
+	};
+
+	enum class topology_policy {
+		local,  // Processors sharing the origin's L3 first, then the rest.
+		remote, // Processors outside the origin's L3 first, then the rest.
+		spread, // Round-robin across all L3 domains, starting with the origin's.
+	};
+
+	enum class topology_smt {
+		physical, // Only the first processor of every physical core, so never two SMT siblings.
+		siblings, // Only processors sharing a physical core, i.e. SMT siblings.
+		both,     // Every processor.
+	};
+
+	// Detect the topology of all logical processors, ordered by id.
+	std::vector<topology_processor> topology_detect();
+
+	// Order all processors relative to the origin, optionally including the origin itself as the first entry.
+	std::vector<uint32_t> topology_order(const std::vector<topology_processor>& topology, uint32_t origin, topology_policy policy, bool include_origin);
+
+	// Parse "local", "remote" or "spread", returning false for anything else.
+	bool topology_policy_parse(const char* name, topology_policy& policy);
+
+	const char* topology_policy_name(topology_policy policy);
+
+	// Whether two different logical processors are SMT siblings on the same physical core.
+	bool topology_siblings(const std::vector<topology_processor>& topology, uint32_t a, uint32_t b);
+
+	// All ordered (reader, writer) pairs of different processors allowed by the SMT filter.
+	std::vector<std::pair<uint32_t, uint32_t>> topology_pairs(const std::vector<topology_processor>& topology, topology_smt smt);
+
+	// Group pairs into rounds that may run at the same time, with no two pairs in a round touching the same physical core.
+	// Every round holds at most max_concurrent pairs, zero means no limit. Pairs keep their relative order.
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> topology_schedule(const std::vector<topology_processor>& topology, const std::vector<std::pair<uint32_t, uint32_t>>& pairs, size_t max_concurrent);
+
+	// Parse "physical", "siblings" or "both", returning false for anything else.
+	bool topology_smt_parse(const char* name, topology_smt& smt);
+
+	const char* topology_smt_name(topology_smt smt);
+} // namespace sandbox